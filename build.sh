@@ -8,6 +8,8 @@ set -e  # Exit on any error
 BUILD_TYPE="Release"
 # Optionally build the gen executable
 BUILD_GEN="OFF"
+# Optionally build the loadgen-bench executable
+BUILD_BENCH="OFF"
 
 # Parse command line arguments
 while [[ $# -gt 0 ]]; do
@@ -24,12 +26,17 @@ while [[ $# -gt 0 ]]; do
             BUILD_GEN="ON"
             shift
             ;;
+        -b|--bench)
+            BUILD_BENCH="ON"
+            shift
+            ;;
         -h|--help)
             echo "Usage: $0 [OPTIONS]"
             echo "Options:"
             echo "  -d, --debug     Build in Debug mode (no optimizations, with debug symbols)"
             echo "  -r, --release   Build in Release mode (optimizations enabled) [default]"
             echo "  -g, --gen       Enable the loadgen gen executable"
+            echo "  -b, --bench     Enable the loadgen-bench executable"
             echo "  -h, --help      Show this help message"
             exit 0
             ;;
@@ -48,8 +55,8 @@ mkdir -p build
 cd build
 
 # Configure with CMake
-echo "Configuring project with CMake (Build type: $BUILD_TYPE, gen: $BUILD_GEN)..."
-cmake -DCMAKE_BUILD_TYPE=$BUILD_TYPE -DBUILD_LOADGEN_GEN=$BUILD_GEN ..
+echo "Configuring project with CMake (Build type: $BUILD_TYPE, gen: $BUILD_GEN, bench: $BUILD_BENCH)..."
+cmake -DCMAKE_BUILD_TYPE=$BUILD_TYPE -DBUILD_LOADGEN_GEN=$BUILD_GEN -DBUILD_LOADGEN_BENCH=$BUILD_BENCH ..
 
 # Format code with clang-format
 echo "Formatting code with clang-format..."
@@ -0,0 +1,757 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench/bench_report.h"
+#include "request/acknowledged_counter.h"
+#include "request/binary_trace_reader.h"
+#include "request/csv_trace_reader.h"
+#include "request/key_encoder.h"
+#include "request/live_key_set.h"
+#include "request/operation_mixer.h"
+#include "request/request_generator.h"
+#include "request/request_prefetcher.h"
+#include "request/scrambled_zipfian_int_distribution.h"
+#include "request/skewed_latest_int_distribution.h"
+#include "request/zipfian_int_distribution.h"
+
+// Usage: loadgen-bench [options]
+//   --workloads DIR    sample TOML workloads (default samples/workloads)
+//   --filter TEXT      only run benchmarks whose name contains TEXT
+//   --requests N       operations per generator benchmark (default 1000000)
+//   --min-time S       minimum duration of a measurement (default 0.2)
+//   --repetitions N    runs per benchmark, the best one is kept (default 3)
+//   --output FILE      write the results to FILE instead of stdout
+//   --baseline FILE    compare with earlier results, exit 1 on regression
+//   --tolerance F      allowed relative regression (default 0.1)
+//
+// The check/ cases are not timed: they export requests around 32-bit
+// boundaries and exit 1 when a request is wrong.
+
+using namespace loadgen::bench;
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct Options {
+    std::string workloads = "samples/workloads";
+    std::string filter;
+    long requests = 1000000;
+    double min_time = 0.2;
+    int repetitions = 3;
+    std::string output;
+    std::string baseline;
+    double tolerance = 0.1;
+};
+
+class Bench {
+public:
+    explicit Bench(const Options &options) : options(options) {}
+
+    bool selected(const std::string &name) const {
+        return options.filter.empty() ||
+               name.find(options.filter) != std::string::npos;
+    }
+
+    void add(const std::string &name, const std::string &unit, double value,
+             bool higher_is_better) {
+        BenchResult result;
+        result.name = name;
+        result.unit = unit;
+        result.value = value;
+        result.higher_is_better = higher_is_better;
+        results.push_back(result);
+        std::cerr << "  " << name << ": " << value << " " << unit << std::endl;
+    }
+
+    /// Record a correctness check, which failed unless `failure` is empty.
+    void check(const std::string &name, const std::string &failure) {
+        if (failure.empty()) {
+            std::cerr << "  " << name << ": ok" << std::endl;
+        } else {
+            failures++;
+            std::cerr << "  " << name << ": FAILED, " << failure << std::endl;
+        }
+    }
+
+    const Options &options;
+    std::vector<BenchResult> results;
+    int failures = 0;
+};
+
+/// Keeps sampled values alive so that the loops are not optimized out.
+volatile long sink;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Seconds per iteration of `body(n)`, which runs n iterations. n grows
+/// until a run lasts at least `min_time`, then the best of `repetitions`
+/// runs of that size is kept.
+double seconds_per_iteration(const std::function<void(long)> &body,
+                             double min_time, int repetitions) {
+    long n = 1;
+    double best;
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        body(n);
+        best = seconds_since(start);
+        if (best >= min_time || n >= (1L << 40)) {
+            break;
+        }
+        long next = best > 0 ? static_cast<long>(n * 1.2 * min_time / best)
+                             : n * 10;
+        n = std::max(next, n * 2);
+    }
+    for (int i = 1; i < repetitions; i++) {
+        Clock::time_point start = Clock::now();
+        body(n);
+        best = std::min(best, seconds_since(start));
+    }
+    return best / static_cast<double>(n);
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Distributions
+// ────────────────────────────────────────────────────────────────────────
+// Key spaces go past 2^31 so that 32-bit truncation shows up as a failure
+// or an outlier.
+const long KEY_SPACES[] = {1000, 1000000, 1L << 32};
+
+template <typename Distribution>
+void bench_samples(Bench &bench, const std::string &name,
+                   Distribution &distribution) {
+    if (!bench.selected(name)) {
+        return;
+    }
+    std::mt19937 engine(std::mt19937::default_seed);
+    long sum = 0;
+    double seconds = seconds_per_iteration(
+        [&](long n) {
+            for (long i = 0; i < n; i++) {
+                sum += distribution(engine);
+            }
+        },
+        bench.options.min_time, bench.options.repetitions);
+    sink = sum;
+    bench.add(name, "ns/sample", seconds * 1e9, false);
+}
+
+void bench_setup(Bench &bench, const std::string &name,
+                 const std::function<long()> &setup) {
+    if (!bench.selected(name)) {
+        return;
+    }
+    long sum = 0;
+    double seconds = seconds_per_iteration(
+        [&](long n) {
+            for (long i = 0; i < n; i++) {
+                sum += setup();
+            }
+        },
+        bench.options.min_time, bench.options.repetitions);
+    sink = sum;
+    bench.add(name, "us/setup", seconds * 1e6, false);
+}
+
+void bench_distributions(Bench &bench) {
+    for (long n : KEY_SPACES) {
+        std::string size = "/n=" + std::to_string(n);
+
+        std::uniform_int_distribution<long> uniform(0, n - 1);
+        bench_samples(bench, "dist/uniform" + size, uniform);
+
+        // Sampling does not depend on the zeta mode; APPROXIMATE keeps the
+        // setup of the large key spaces short.
+        zipfian_int_distribution<long> zipfian(0, n - 1,
+                                               ZetaMode::APPROXIMATE);
+        bench_samples(bench, "dist/zipfian" + size, zipfian);
+
+        scrambled_zipfian_int_distribution<long> scrambled(0, n - 1);
+        bench_samples(bench, "dist/scrambled_zipfian" + size, scrambled);
+
+        acknowledged_counter<long> counter(n);
+        acknowledged_counter<long> *counter_ptr = &counter;
+        zipfian_int_distribution<long> latest_zipfian(
+            0, n - 1, ZetaMode::APPROXIMATE);
+        zipfian_int_distribution<long> *latest_zipfian_ptr = &latest_zipfian;
+        skewed_latest_int_distribution<long> latest(counter_ptr,
+                                                    latest_zipfian_ptr);
+        bench_samples(bench, "dist/skewed_latest" + size, latest);
+
+        std::binomial_distribution<long> binomial(n, 0.5);
+        bench_samples(bench, "dist/binomial" + size, binomial);
+
+        // One draw per setup keeps the construction from being elided.
+        std::mt19937 engine(std::mt19937::default_seed);
+        bench_setup(bench, "setup/zipfian_approximate" + size, [&]() {
+            zipfian_int_distribution<long> z(0, n - 1, ZetaMode::APPROXIMATE);
+            return z(engine);
+        });
+        if (n <= 1000000) {
+            bench_setup(bench, "setup/zipfian_exact" + size, [&]() {
+                zipfian_int_distribution<long> z(0, n - 1, ZetaMode::EXACT);
+                return z(engine);
+            });
+        }
+    }
+}
+
+/// OperationMixer behind the interface bench_samples() draws from.
+struct MixerSamples {
+    explicit MixerSamples(const workload::OperationMixer &mixer) :
+        mixer(mixer), uniform(0.0, 1.0) {}
+
+    workload::OperationMixer mixer;
+    std::uniform_real_distribution<double> uniform;
+
+    template <typename Engine> long operator()(Engine &engine) {
+        return static_cast<long>(mixer.select(uniform(engine)));
+    }
+};
+
+void bench_mixers(Bench &bench) {
+    // Every type of the operation model, the most frequent last, which is
+    // the worst order for the cumulative scan.
+    const std::pair<loadgen::types::Type, double> weights[] = {
+        {loadgen::types::Type::SCAN, 0.05},
+        {loadgen::types::Type::DEL, 0.05},
+        {loadgen::types::Type::MULTI_GET, 0.1},
+        {loadgen::types::Type::READ_MODIFY_WRITE, 0.1},
+        {loadgen::types::Type::WRITE, 0.1},
+        {loadgen::types::Type::UPDATE, 0.2},
+        {loadgen::types::Type::READ, 0.4}};
+    const size_t type_counts[] = {2, 4, 7};
+    for (size_t n : type_counts) {
+        std::vector<std::pair<loadgen::types::Type, double>> mix(
+            weights + (7 - n), weights + 7);
+        std::string types = "/types=" + std::to_string(n);
+        MixerSamples cumulative(workload::OperationMixer(
+            mix, workload::OperationMixer::Method::CUMULATIVE));
+        bench_samples(bench, "mixer/cumulative" + types, cumulative);
+        MixerSamples alias(workload::OperationMixer(
+            mix, workload::OperationMixer::Method::ALIAS));
+        bench_samples(bench, "mixer/alias" + types, alias);
+    }
+}
+
+/// Uniform live key of a LiveKeySet, behind the interface bench_samples()
+/// draws from.
+struct LiveKeySamples {
+    LiveKeySamples(const workload::LiveKeySet &live_keys, long n) :
+        live_keys(live_keys), uniform(0, live_keys.rank(n) - 1) {}
+
+    const workload::LiveKeySet &live_keys;
+    std::uniform_int_distribution<long> uniform;
+
+    template <typename Engine> long operator()(Engine &engine) {
+        return live_keys.select(uniform(engine));
+    }
+};
+
+void bench_live_keys(Bench &bench) {
+    // 1% of the keys deleted at random, over the whole key space.
+    const long key_spaces[] = {1000000, 1L << 28};
+    for (long n : key_spaces) {
+        std::string size = "/n=" + std::to_string(n);
+        if (!bench.selected("live_keys/select" + size) &&
+            !bench.selected("live_keys/memory" + size)) {
+            continue;
+        }
+        workload::LiveKeySet live_keys;
+        std::mt19937 engine(std::mt19937::default_seed);
+        std::uniform_int_distribution<long> keys(0, n - 1);
+        for (long i = 0; i < n / 100; i++) {
+            live_keys.erase(keys(engine));
+        }
+        LiveKeySamples samples(live_keys, n);
+        bench_samples(bench, "live_keys/select" + size, samples);
+        if (bench.selected("live_keys/memory" + size)) {
+            bench.add("live_keys/memory" + size, "bits/key",
+                      8.0 * static_cast<double>(live_keys.memory_bytes()) /
+                          static_cast<double>(n),
+                      false);
+        }
+    }
+}
+
+/// Encoded size of uniform keys, behind the interface bench_samples() draws
+/// from.
+struct KeySamples {
+    explicit KeySamples(
+        const workload::RequestGenerator::Configuration &config) :
+        encoder(config), uniform(0, (1L << 32) - 1) {}
+
+    workload::KeyEncoder encoder;
+    std::uniform_int_distribution<long> uniform;
+    char buffer[workload::KeyEncoder::MAX_SIZE];
+
+    template <typename Engine> long operator()(Engine &engine) {
+        return static_cast<long>(encoder.encode(uniform(engine), buffer));
+    }
+};
+
+void bench_keys(Bench &bench) {
+    const char *encodings[] = {"DECIMAL", "USER_HASH", "BINARY", "VARIABLE"};
+    for (const char *encoding : encodings) {
+        workload::RequestGenerator::Configuration config;
+        config.key_encoding = encoding;
+        KeySamples samples(config);
+        bench_samples(bench, std::string("keys/") + encoding, samples);
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Generator
+// ────────────────────────────────────────────────────────────────────────
+std::vector<std::string> list_workloads(const std::string &dir) {
+    std::vector<std::string> paths;
+    DIR *d = opendir(dir.c_str());
+    if (d == nullptr) {
+        std::cerr << "Cannot open workload directory " << dir << std::endl;
+        return paths;
+    }
+    while (struct dirent *entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() > 5 && name.substr(name.size() - 5) == ".toml") {
+            paths.push_back(dir + "/" + name);
+        }
+    }
+    closedir(d);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+std::string stem(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    std::string name =
+        slash == std::string::npos ? path : path.substr(slash + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+/// Operations per second of RequestGenerator::next() (or, with `prefetch`,
+/// of RequestPrefetcher::next() on the generator) over the operations phase
+/// of `path` with `records` loaded keys.
+double run_next(const Bench &bench, const std::string &path, long records,
+                const std::string &values, bool prefetch) {
+    workload::RequestGenerator generator(path, false);
+    workload::RequestGenerator::Configuration &config = generator.config();
+    // Values cost far more than keys; fewer requests keep the run short.
+    long requests = values == "none" ? bench.options.requests
+                                     : bench.options.requests / 10;
+    config.n_records = records;
+    config.n_operations = std::max(requests, 1L);
+    config.gen_values = values != "none";
+    config.value_generator = values == "pool" ? "POOL" : "RANDOM";
+    config.zipfian_zeta = "APPROXIMATE";
+    generator.initialize();
+    generator.skip_current_phase();
+
+    loadgen::types::Type type;
+    long key, scan_size, count = 0, sum = 0;
+    workload::ByteView value;
+    std::unique_ptr<workload::RequestPrefetcher> prefetcher;
+    Clock::time_point start = Clock::now();
+    if (prefetch) {
+        prefetcher.reset(new workload::RequestPrefetcher(
+            generator, workload::RequestPrefetcher::Options()));
+        while (prefetcher->next(type, key, value, scan_size) !=
+               workload::RequestGenerator::Phase::DONE) {
+            prefetcher->acknowledge(key);
+            sum += key + static_cast<long>(value.size);
+            count++;
+        }
+    } else {
+        while (generator.next(type, key, value, scan_size) !=
+               workload::RequestGenerator::Phase::DONE) {
+            generator.acknowledge(key);
+            sum += key + static_cast<long>(value.size);
+            count++;
+        }
+    }
+    double seconds = seconds_since(start);
+    sink = sum;
+    return count / seconds;
+}
+
+/// Path of a new empty file in $TMPDIR (default /tmp).
+std::string temporary_file() {
+    const char *tmpdir = getenv("TMPDIR");
+    std::string file = std::string(tmpdir ? tmpdir : "/tmp") +
+                       "/loadgen-bench-XXXXXX";
+    std::vector<char> buffer(file.begin(), file.end());
+    buffer.push_back('\0');
+    int fd = mkstemp(buffer.data());
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create a temporary file " + file);
+    }
+    close(fd);
+    return buffer.data();
+}
+
+/// Megabytes per second written by generate_to_file() for `path`, loading
+/// included.
+double run_export(const Bench &bench, const std::string &path,
+                  const std::string &format) {
+    std::string file = temporary_file();
+
+    workload::RequestGenerator generator(path, false);
+    workload::RequestGenerator::Configuration &config = generator.config();
+    config.n_records = std::min(config.n_records, bench.options.requests);
+    config.n_operations = bench.options.requests;
+    config.export_format = format == "binary" ? "BINARY" : "CSV";
+    generator.initialize();
+
+    Clock::time_point start = Clock::now();
+    generator.generate_to_file(file, false);
+    double seconds = seconds_since(start);
+
+    struct stat st;
+    double bytes = stat(file.c_str(), &st) == 0 ? st.st_size : 0;
+    unlink(file.c_str());
+    return bytes / 1e6 / seconds;
+}
+
+/// Best throughput of `repetitions` runs.
+void bench_throughput(Bench &bench, const std::string &name,
+                      const std::string &unit,
+                      const std::function<double()> &run) {
+    if (!bench.selected(name)) {
+        return;
+    }
+    double best = 0;
+    for (int i = 0; i < bench.options.repetitions; i++) {
+        best = std::max(best, run());
+    }
+    bench.add(name, unit, best, true);
+}
+
+void bench_generator(Bench &bench) {
+    std::vector<std::string> workloads =
+        list_workloads(bench.options.workloads);
+    for (size_t i = 0; i < workloads.size(); i++) {
+        const std::string &path = workloads[i];
+        workload::RequestGenerator probe(path, false);
+        long records = probe.config().n_records;
+
+        std::string prefix = "next/" + stem(path) + "/records=";
+        // The sample key space, then a larger one as the distributions would
+        // see in production.
+        const long key_spaces[] = {records, records * 100};
+        for (long n : key_spaces) {
+            const char *values[] = {"none", "random", "pool"};
+            for (const char *v : values) {
+                if (n != records && std::string(v) != "none") {
+                    continue;
+                }
+                bench_throughput(
+                    bench, prefix + std::to_string(n) + "/values=" + v,
+                    "ops/s",
+                    [&]() { return run_next(bench, path, n, v, false); });
+            }
+        }
+        // Requests as a consumer takes them from a producer thread.
+        const char *values[] = {"none", "random"};
+        for (const char *v : values) {
+            bench_throughput(bench,
+                             "prefetch/" + stem(path) + "/values=" + v,
+                             "ops/s", [&]() {
+                                 return run_next(bench, path, records, v,
+                                                 true);
+                             });
+        }
+
+        const char *formats[] = {"csv", "binary"};
+        for (const char *format : formats) {
+            bench_throughput(
+                bench, "export/" + stem(path) + "/format=" + format, "MB/s",
+                [&]() { return run_export(bench, path, format); });
+        }
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Boundaries
+// ────────────────────────────────────────────────────────────────────────
+// Loading records and operations around 2^31 and 2^32, and keys past the 10
+// digits CSV keys are padded to. The requests are exported as a range in
+// both formats and read back; an index or key truncated to 32 bits makes a
+// check fail.
+
+const long BOUNDARIES[] = {1L << 31, 1L << 32};
+
+/// CSV keys past 10 digits are written in full.
+const long ELEVEN_DIGITS = 12000000000L;
+
+/// One request of an exported trace.
+struct ExportedRequest {
+    loadgen::types::Type type;
+    long key;
+    long scan_size;
+    /// Key field of CSV traces, empty for binary ones.
+    std::string encoded_key;
+
+    bool operator==(const ExportedRequest &other) const {
+        return type == other.type && key == other.key &&
+               scan_size == other.scan_size;
+    }
+};
+
+std::vector<ExportedRequest> read_csv(const std::string &file) {
+    workload::CsvTraceReader reader(file);
+    workload::CsvTraceRange range = reader.range();
+    std::vector<ExportedRequest> requests;
+    for (workload::CsvTraceRange::iterator it = range.begin();
+         it != range.end(); ++it) {
+        ExportedRequest request = {it->type, it->key, it->scan_size,
+                                   it->encoded_key.str()};
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+std::vector<ExportedRequest> read_binary(const std::string &file) {
+    workload::BinaryTraceReader reader(file);
+    std::vector<ExportedRequest> requests;
+    ExportedRequest request;
+    std::string value;
+    while (reader.next(request.type, request.key, value,
+                       request.scan_size) !=
+           workload::RequestGenerator::Phase::DONE) {
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+typedef std::function<void(workload::RequestGenerator::Configuration &)>
+    Configure;
+
+/// Requests [begin, end) of the COUNTER workload at `path`, edited by
+/// `configure`, exported by generate_range_to_file() in `format` and read
+/// back.
+std::vector<ExportedRequest> export_range(const std::string &path,
+                                          const Configure &configure,
+                                          long begin, long end,
+                                          const std::string &format) {
+    workload::RequestGenerator generator(path, false);
+    workload::RequestGenerator::Configuration &config = generator.config();
+    config.rng_mode = "COUNTER";
+    config.export_format = format == "binary" ? "BINARY" : "CSV";
+    configure(config);
+    generator.initialize();
+
+    std::string file = temporary_file();
+    generator.generate_range_to_file(file, begin, end);
+    std::vector<ExportedRequest> requests =
+        format == "binary" ? read_binary(file) : read_csv(file);
+    unlink(file.c_str());
+    return requests;
+}
+
+/// Why the requests [begin, end) of a workload of `n_records` loading
+/// records, exported in both formats, are wrong, or "" when they are right:
+/// loading records in order, inserts continuing the key sequence, the other
+/// keys below the inserts before them, keys padded to 10 digits in CSV and
+/// both formats holding the same requests.
+std::string check_requests(const std::vector<ExportedRequest> &csv,
+                           const std::vector<ExportedRequest> &binary,
+                           long n_records, long begin, long end) {
+    if (csv.size() != static_cast<size_t>(end - begin) ||
+        binary.size() != csv.size()) {
+        return std::to_string(csv.size()) + " CSV and " +
+               std::to_string(binary.size()) + " binary requests instead of " +
+               std::to_string(end - begin);
+    }
+    // Workloads start from a range of loading records, or have no inserts.
+    long next_insert = n_records;
+    for (size_t i = 0; i < csv.size(); i++) {
+        const ExportedRequest &request = csv[i];
+        long index = begin + static_cast<long>(i);
+        std::string at = " at request " + std::to_string(index);
+        if (!(binary[i] == request)) {
+            return "binary and CSV requests differ" + at;
+        }
+        if (index < n_records) {
+            if (request.type != loadgen::types::Type::WRITE ||
+                request.key != index) {
+                return "loading record with key " +
+                       std::to_string(request.key) + at;
+            }
+        } else if (request.type == loadgen::types::Type::WRITE &&
+                   request.key == next_insert) {
+            next_insert++;
+        } else if (request.key < 0 || request.key >= next_insert) {
+            return "key " + std::to_string(request.key) + " not below " +
+                   std::to_string(next_insert) + at;
+        }
+        std::string digits = std::to_string(request.key);
+        std::string padded =
+            std::string(digits.size() < 10 ? 10 - digits.size() : 0, '0') +
+            digits;
+        if (request.encoded_key != padded) {
+            return "CSV key " + request.encoded_key + " for key " + digits +
+                   at;
+        }
+    }
+    return "";
+}
+
+/// Export [begin, end) in both formats and check it.
+std::string check_range(const std::string &path, const Configure &configure,
+                        long n_records, long begin, long end) {
+    return check_requests(export_range(path, configure, begin, end, "csv"),
+                          export_range(path, configure, begin, end, "binary"),
+                          n_records, begin, end);
+}
+
+void bench_boundaries(Bench &bench) {
+    std::vector<std::string> workloads =
+        list_workloads(bench.options.workloads);
+    std::vector<long> key_spaces(BOUNDARIES, BOUNDARIES + 2);
+    key_spaces.push_back(ELEVEN_DIGITS);
+    for (size_t i = 0; i < workloads.size(); i++) {
+        const std::string &path = workloads[i];
+
+        // The last loading records, then the first operations and their
+        // inserts.
+        for (long n : key_spaces) {
+            std::string name =
+                "check/" + stem(path) + "/records=" + std::to_string(n);
+            if (!bench.selected(name)) {
+                continue;
+            }
+            Configure records = [n](
+                workload::RequestGenerator::Configuration &config) {
+                config.n_records = n;
+                config.n_operations = 64;
+            };
+            bench.check(name, check_range(path, records, n, n - 8, n + 64));
+        }
+
+        // Operations around the boundary. Without inserts, seek() reaches
+        // them in constant time; operations 2^32 later must differ.
+        const long records = 1000;
+        for (long n : BOUNDARIES) {
+            std::string name =
+                "check/" + stem(path) + "/operations=" + std::to_string(n);
+            if (!bench.selected(name)) {
+                continue;
+            }
+            Configure operations = [n, records](
+                workload::RequestGenerator::Configuration &config) {
+                config.n_records = records;
+                config.n_operations = n + 8;
+                config.read_proportion += config.insert_proportion;
+                config.insert_proportion = 0;
+            };
+            long begin = records + n - 8, end = records + n + 8;
+            std::string failure =
+                check_range(path, operations, records, begin, end);
+            if (failure.empty() && n >= (1L << 32)) {
+                std::vector<ExportedRequest> late =
+                    export_range(path, operations, end - 8, end, "csv");
+                std::vector<ExportedRequest> early =
+                    export_range(path, operations, end - 8 - (1L << 32),
+                                 end - (1L << 32), "csv");
+                if (late == early) {
+                    failure = "operations repeat those 2^32 earlier";
+                }
+            }
+            bench.check(name, failure);
+        }
+    }
+}
+
+bool parse_options(int argc, char const *argv[], Options &options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--workloads") {
+            options.workloads = value;
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--requests") {
+            options.requests = atol(value.c_str());
+        } else if (arg == "--min-time") {
+            options.min_time = atof(value.c_str());
+        } else if (arg == "--repetitions") {
+            options.repetitions = atoi(value.c_str());
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (arg == "--baseline") {
+            options.baseline = value;
+        } else if (arg == "--tolerance") {
+            options.tolerance = atof(value.c_str());
+        } else {
+            return false;
+        }
+    }
+    return options.requests > 0 && options.repetitions > 0;
+}
+
+} // namespace
+
+int main(int argc, char const *argv[]) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--workloads DIR] [--filter TEXT] [--requests N]"
+                     " [--min-time S] [--repetitions N] [--output FILE]"
+                     " [--baseline FILE]"
+                     " [--tolerance F]"
+                  << std::endl;
+        return 2;
+    }
+
+    Bench bench(options);
+    std::cerr << "Distributions" << std::endl;
+    bench_distributions(bench);
+    bench_mixers(bench);
+    bench_live_keys(bench);
+    bench_keys(bench);
+    std::cerr << "Generator" << std::endl;
+    bench_generator(bench);
+    std::cerr << "Boundaries" << std::endl;
+    bench_boundaries(bench);
+
+    if (options.output.empty()) {
+        write_results(std::cout, bench.results);
+    } else {
+        std::ofstream out(options.output);
+        write_results(out, bench.results);
+    }
+
+    if (bench.failures > 0) {
+        std::cerr << bench.failures << " failed check(s)" << std::endl;
+        return 1;
+    }
+    if (!options.baseline.empty()) {
+        std::vector<BenchResult> baseline = read_results(options.baseline);
+        std::cerr << "Comparison with " << options.baseline << " (tolerance "
+                  << options.tolerance * 100 << "%)" << std::endl;
+        int regressions = compare_results(bench.results, baseline,
+                                          options.tolerance, std::cerr);
+        if (regressions > 0) {
+            std::cerr << regressions << " regression(s)" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
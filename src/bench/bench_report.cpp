@@ -0,0 +1,114 @@
+#include "bench_report.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace loadgen {
+namespace bench {
+using namespace std;
+
+// ────────────────────────────────────────────────────────────────────────
+// CSV
+// ────────────────────────────────────────────────────────────────────────
+static const char *HEADER = "name,unit,value,higher_is_better";
+
+void write_results(std::ostream &os, const std::vector<BenchResult> &results) {
+    os << HEADER << "\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        char value[64];
+        snprintf(value, sizeof(value), "%.6g", r.value);
+        os << r.name << "," << r.unit << "," << value << ","
+           << (r.higher_is_better ? 1 : 0) << "\n";
+    }
+    os.flush();
+}
+
+std::vector<BenchResult> read_results(const std::string &path) {
+    ifstream in(path);
+    if (!in) {
+        throw runtime_error("Cannot open benchmark results " + path);
+    }
+
+    vector<BenchResult> results;
+    string line;
+    size_t number = 0;
+    while (getline(in, line)) {
+        number++;
+        if (line.empty() || line == HEADER) {
+            continue;
+        }
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 4) {
+            throw runtime_error("Malformed benchmark results " + path +
+                                " line " + to_string(number));
+        }
+        BenchResult r;
+        r.name = fields[0];
+        r.unit = fields[1];
+        r.value = strtod(fields[2].c_str(), nullptr);
+        r.higher_is_better = fields[3] == "1";
+        results.push_back(r);
+    }
+    return results;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Baseline comparison
+// ────────────────────────────────────────────────────────────────────────
+int compare_results(const std::vector<BenchResult> &results,
+                    const std::vector<BenchResult> &baseline,
+                    double tolerance, std::ostream &report) {
+    map<string, const BenchResult *> by_name;
+    for (size_t i = 0; i < baseline.size(); i++) {
+        by_name[baseline[i].name] = &baseline[i];
+    }
+
+    int regressions = 0;
+    char line[512];
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult &r = results[i];
+        auto found = by_name.find(r.name);
+        if (found == by_name.end() || found->second->unit != r.unit) {
+            snprintf(line, sizeof(line), "  new         %-56s %12.4g %s\n",
+                     r.name.c_str(), r.value, r.unit.c_str());
+            report << line;
+            continue;
+        }
+
+        const BenchResult &base = *found->second;
+        // Relative change, positive when the result got better.
+        double change = 0;
+        if (base.value > 0) {
+            change = (r.value - base.value) / base.value;
+            if (!r.higher_is_better) {
+                change = -change;
+            }
+        }
+        const char *status = "ok";
+        if (change < -tolerance) {
+            status = "REGRESSION";
+            regressions++;
+        } else if (change > tolerance) {
+            status = "improved";
+        }
+        snprintf(line, sizeof(line),
+                 "  %-11s %-56s %12.4g %s (baseline %.4g, %+.1f%%)\n", status,
+                 r.name.c_str(), r.value, r.unit.c_str(), base.value,
+                 change * 100);
+        report << line;
+    }
+    return regressions;
+}
+
+} // namespace bench
+} // namespace loadgen
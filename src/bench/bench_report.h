@@ -0,0 +1,42 @@
+#ifndef LOADGEN_BENCH_BENCH_REPORT_H
+#define LOADGEN_BENCH_BENCH_REPORT_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace loadgen {
+namespace bench {
+
+/// One measurement of loadgen-bench.
+struct BenchResult {
+    /// Unique name, "<group>/<case>/<parameters>".
+    std::string name;
+    /// "ns/sample", "ops/s", "MB/s", ...
+    std::string unit;
+    double value = 0;
+    /// Throughputs are better when higher, latencies when lower.
+    bool higher_is_better = false;
+};
+
+/// Write `results` as CSV: a `name,unit,value,higher_is_better` header and
+/// one line per result.
+void write_results(std::ostream &os, const std::vector<BenchResult> &results);
+
+/// Read results written by write_results().
+/// @throws std::runtime_error when the file cannot be read or parsed.
+std::vector<BenchResult> read_results(const std::string &path);
+
+/// Compare `results` with `baseline` by name and print one line per result
+/// to `report`. A result regresses when it is worse than its baseline by
+/// more than `tolerance` (0.1 = 10%); results without a baseline are listed
+/// as new.
+/// @return Number of regressions.
+int compare_results(const std::vector<BenchResult> &results,
+                    const std::vector<BenchResult> &baseline,
+                    double tolerance, std::ostream &report);
+
+} // namespace bench
+} // namespace loadgen
+
+#endif
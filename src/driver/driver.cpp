@@ -0,0 +1,413 @@
+#include "driver.h"
+#include "../request/request_prefetcher.h"
+#include "../request/request_stream.h"
+#include "../../external/toml11/include/toml.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace loadgen {
+namespace driver {
+using namespace std;
+using workload::RequestGenerator;
+
+typedef chrono::steady_clock Clock;
+
+// ────────────────────────────────────────────────────────────────────────
+// Options
+// ────────────────────────────────────────────────────────────────────────
+// TOML distinguishes `rate = 1000` from `rate = 1000.0`; accept both.
+static double find_number(const toml::value &config, const char *key,
+                          double fallback) {
+    if (!config.contains("driver") || !config.at("driver").contains(key)) {
+        return fallback;
+    }
+    const toml::value &value = config.at("driver").at(key);
+    if (value.is_integer()) {
+        return static_cast<double>(value.as_integer());
+    }
+    return value.as_floating();
+}
+
+DriverOptions load_driver_options(const std::string &config_path) {
+    const auto config = toml::parse(config_path);
+
+    DriverOptions options;
+    options.clients = toml::find_or<int>(config, "driver", "clients", 1);
+    options.arrival =
+        toml::find_or<string>(config, "driver", "arrival", "CLOSED");
+    options.rate = find_number(config, "rate", 0);
+    options.expected_interval_ns = toml::find_or<long>(
+        config, "driver", "expected_interval_ns", 0L);
+    options.batch_size =
+        toml::find_or<long>(config, "driver", "batch_size", 64L);
+    options.max_duration_s = find_number(config, "max_duration_s", 0);
+    options.adapter =
+        toml::find_or<string>(config, "driver", "adapter", "HASH_MAP");
+    options.streams =
+        toml::find_or<string>(config, "driver", "streams", "SHARED");
+    options.prefetch = toml::find_or<long>(config, "driver", "prefetch", 0L);
+    options.prefetch_pending =
+        toml::find_or<long>(config, "driver", "prefetch_pending", 1024L);
+    return options;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Report
+// ────────────────────────────────────────────────────────────────────────
+void OperationStats::merge(const OperationStats &other) {
+    latency.merge(other.latency);
+    service.merge(other.service);
+    misses += other.misses;
+}
+
+OperationStats &DriverReport::at(RequestGenerator::Phase phase,
+                                 loadgen::types::Type type) {
+    return stats[static_cast<int>(phase)][static_cast<int>(type)];
+}
+
+const OperationStats &DriverReport::at(RequestGenerator::Phase phase,
+                                       loadgen::types::Type type) const {
+    return stats[static_cast<int>(phase)][static_cast<int>(type)];
+}
+
+static const char *PHASE_NAMES[] = {"LOADING", "OPERATIONS"};
+static const char *TYPE_NAMES[] = {"READ",   "WRITE",
+                                   "SCAN",   "DEL",
+                                   "UPDATE", "READ_MODIFY_WRITE",
+                                   "MULTI_GET"};
+
+static void print_histogram(std::ostream &os, const char *label,
+                            const LatencyHistogram &h) {
+    char line[256];
+    snprintf(line, sizeof(line),
+             "    %-8s mean=%.1f p50=%.1f p90=%.1f p99=%.1f p99.9=%.1f "
+             "max=%.1f\n",
+             label, h.mean() / 1e3, h.percentile(50) / 1e3,
+             h.percentile(90) / 1e3, h.percentile(99) / 1e3,
+             h.percentile(99.9) / 1e3, h.max() / 1e3);
+    os << line;
+}
+
+void DriverReport::print(std::ostream &os) const {
+    for (int phase = 0; phase < PHASES; phase++) {
+        uint64_t total = 0;
+        for (int type = 0; type < TYPES; type++) {
+            total += stats[phase][type].service.count();
+        }
+        if (total == 0) {
+            continue;
+        }
+        char line[256];
+        snprintf(line, sizeof(line), "[%s] %llu ops in %.3f s (%.0f ops/s)\n",
+                 PHASE_NAMES[phase], static_cast<unsigned long long>(total),
+                 elapsed[phase],
+                 elapsed[phase] > 0 ? total / elapsed[phase] : 0.0);
+        os << line;
+
+        for (int type = 0; type < TYPES; type++) {
+            const OperationStats &s = stats[phase][type];
+            if (s.service.count() == 0) {
+                continue;
+            }
+            snprintf(line, sizeof(line), "  %s ops=%llu misses=%llu (us)\n",
+                     TYPE_NAMES[type],
+                     static_cast<unsigned long long>(s.service.count()),
+                     static_cast<unsigned long long>(s.misses));
+            os << line;
+            print_histogram(os, "latency", s.latency);
+            print_histogram(os, "service", s.service);
+        }
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Driver
+// ────────────────────────────────────────────────────────────────────────
+Driver::Driver(const DriverOptions &options) : options_(options) {
+    if (options_.arrival != "CLOSED" && options_.arrival != "OPEN" &&
+        options_.arrival != "WORKLOAD") {
+        throw invalid_argument("Unknown driver arrival: " + options_.arrival);
+    }
+    if (options_.arrival == "OPEN" && !(options_.rate > 0)) {
+        throw invalid_argument("OPEN arrival requires a positive rate");
+    }
+    if (options_.streams != "SHARED" && options_.streams != "INTERLEAVED" &&
+        options_.streams != "RANGES") {
+        throw invalid_argument("Unknown driver streams: " + options_.streams);
+    }
+    if (options_.prefetch < 0 || options_.prefetch_pending <= 0) {
+        throw invalid_argument("prefetch must be non-negative and "
+                               "prefetch_pending positive");
+    }
+    if (options_.prefetch > 0 && options_.streams != "SHARED") {
+        throw invalid_argument("prefetch requires SHARED streams");
+    }
+}
+
+namespace {
+
+/// Per-client accumulation, merged into the report at the end.
+struct ClientResult {
+    OperationStats stats[DriverReport::PHASES][DriverReport::TYPES];
+    Clock::time_point first[DriverReport::PHASES];
+    Clock::time_point last[DriverReport::PHASES];
+    bool active[DriverReport::PHASES] = {false, false};
+};
+
+} // namespace
+
+DriverReport Driver::run(RequestGenerator &generator, KvAdapter &adapter) {
+    // Operations are issued at the times of the workload schedule instead
+    // of every 1 / rate seconds.
+    const bool workload_times = options_.arrival == "WORKLOAD";
+    if (workload_times && generator.config().arrival == "NONE") {
+        throw invalid_argument(
+            "WORKLOAD arrival requires a workload.arrival schedule");
+    }
+    const bool open = options_.arrival == "OPEN" || workload_times;
+    const bool shared = options_.streams == "SHARED";
+    const size_t clients =
+        static_cast<size_t>(options_.clients > 0 ? options_.clients : 1);
+    // Open-loop clients of a shared generator take one request at a time so
+    // that every arrival goes to the first idle client. Partitioned clients
+    // follow their own share of the schedule.
+    const size_t pull = open && shared
+                            ? 1
+                            : static_cast<size_t>(max(options_.batch_size, 1L));
+    const Clock::duration interval =
+        open && !workload_times
+            ? chrono::duration_cast<Clock::duration>(
+                  chrono::duration<double>(1.0 / options_.rate))
+            : Clock::duration::zero();
+    const uint64_t expected_interval =
+        static_cast<uint64_t>(max(options_.expected_interval_ns, 0L));
+
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point deadline =
+        options_.max_duration_s > 0
+            ? start + chrono::duration_cast<Clock::duration>(
+                          chrono::duration<double>(options_.max_duration_s))
+            : Clock::time_point::max();
+
+    vector<unique_ptr<workload::RequestStream>> streams;
+    if (!shared) {
+        streams = generator.make_streams(
+            clients, options_.streams == "RANGES"
+                         ? RequestGenerator::StreamKeys::RANGES
+                         : RequestGenerator::StreamKeys::INTERLEAVED);
+    }
+
+    // Takes the requests of a shared generator on its own thread; clients
+    // then only copy them out.
+    unique_ptr<workload::RequestPrefetcher> prefetcher;
+    if (options_.prefetch > 0) {
+        workload::RequestPrefetcher::Options prefetch;
+        prefetch.capacity = static_cast<size_t>(options_.prefetch);
+        prefetch.max_pending = options_.prefetch_pending;
+        prefetcher.reset(new workload::RequestPrefetcher(generator, prefetch));
+    }
+
+    // Guards the shared generator's (or prefetcher's) next_batch() and
+    // arrival sequence; acknowledge() is lock-free.
+    mutex source;
+    uint64_t scheduled = 0;
+    // Operations start once loading is complete; arrivals are scheduled from
+    // that point.
+    once_flag schedule_once;
+    Clock::time_point schedule_start;
+    atomic<bool> stop(false);
+    // Loading requests not completed yet. A shared generator hands out the
+    // whole loading phase first, so counting its requests as they are taken
+    // is enough; partitioned streams count theirs upfront.
+    atomic<long> loading(0);
+    for (size_t c = 0; c < streams.size(); c++) {
+        loading += streams[c]->loading_records();
+    }
+
+    vector<ClientResult> results(clients);
+    vector<thread> threads;
+    for (size_t c = 0; c < clients; c++) {
+        threads.push_back(thread([&, c]() {
+            ClientResult &result = results[c];
+            RequestGenerator::RequestBatch batch;
+            // Position of each operation of the batch in the schedule.
+            vector<uint64_t> slots(pull);
+            uint64_t client_scheduled = 0;
+            string value;
+
+            while (!stop.load(memory_order_relaxed)) {
+                size_t n;
+                if (shared) {
+                    lock_guard<mutex> lock(source);
+                    n = prefetcher ? prefetcher->next_batch(pull, batch)
+                                   : generator.next_batch(pull, batch);
+                    for (size_t i = 0; i < n; i++) {
+                        if (batch.phases[i] !=
+                            RequestGenerator::Phase::OPERATIONS) {
+                            loading++;
+                        } else {
+                            slots[i] = scheduled++;
+                        }
+                    }
+                } else {
+                    n = streams[c]->next_batch(pull, batch);
+                    for (size_t i = 0; i < n; i++) {
+                        if (batch.phases[i] ==
+                            RequestGenerator::Phase::OPERATIONS) {
+                            slots[i] = client_scheduled++ * clients + c;
+                        }
+                    }
+                }
+                if (n == 0) {
+                    break;
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    RequestGenerator::Phase phase = batch.phases[i];
+                    loadgen::types::Type type = batch.types[i];
+                    long key = batch.keys[i];
+                    bool timed =
+                        open && phase == RequestGenerator::Phase::OPERATIONS;
+                    if (phase == RequestGenerator::Phase::OPERATIONS) {
+                        while (loading.load() > 0 && !stop.load()) {
+                            this_thread::yield();
+                        }
+                        if (stop.load()) {
+                            break;
+                        }
+                        call_once(schedule_once,
+                                  [&]() { schedule_start = Clock::now(); });
+                    }
+                    Clock::time_point arrival;
+                    if (timed) {
+                        if (workload_times) {
+                            arrival = schedule_start +
+                                      chrono::duration_cast<Clock::duration>(
+                                          chrono::nanoseconds(
+                                              batch.arrival_times[i]));
+                        } else {
+                            arrival = schedule_start + interval * slots[i];
+                        }
+                        this_thread::sleep_until(arrival);
+                    }
+
+                    Clock::time_point begin = Clock::now();
+                    if (begin >= deadline) {
+                        stop = true;
+                        // The inserts left in this batch are never
+                        // acknowledged; a client waiting for the prefetcher
+                        // would wait for them.
+                        if (prefetcher) {
+                            prefetcher->cancel();
+                        }
+                        break;
+                    }
+                    bool hit = true;
+                    if (type == loadgen::types::Type::READ) {
+                        hit = adapter.get(key, value);
+                    } else if (type == loadgen::types::Type::WRITE) {
+                        adapter.put(key,
+                                    batch.values.data() +
+                                        batch.value_offsets[i],
+                                    batch.value_lengths[i]);
+                    } else if (type == loadgen::types::Type::SCAN) {
+                        hit = adapter.scan(key, batch.scan_sizes[i]) > 0;
+                    } else if (type == loadgen::types::Type::DEL) {
+                        hit = adapter.remove(key);
+                    } else if (type ==
+                               loadgen::types::Type::READ_MODIFY_WRITE) {
+                        hit = adapter.get(key, value);
+                        adapter.put(key,
+                                    batch.values.data() +
+                                        batch.value_offsets[i],
+                                    batch.value_lengths[i]);
+                    } else if (type == loadgen::types::Type::MULTI_GET) {
+                        hit = adapter.multi_get(batch.multi_get_keys.data() +
+                                                    batch.key_offsets[i],
+                                                batch.scan_sizes[i]) > 0;
+                    }
+                    Clock::time_point end = Clock::now();
+                    if (phase != RequestGenerator::Phase::OPERATIONS) {
+                        loading--;
+                    }
+
+                    if (type == loadgen::types::Type::WRITE &&
+                        phase == RequestGenerator::Phase::OPERATIONS) {
+                        if (shared) {
+                            generator.acknowledge(key);
+                        } else {
+                            streams[c]->acknowledge(key);
+                        }
+                    }
+
+                    int p = static_cast<int>(phase);
+                    OperationStats &stats =
+                        result.stats[p][static_cast<int>(type)];
+                    uint64_t service = static_cast<uint64_t>(
+                        chrono::duration_cast<chrono::nanoseconds>(end - begin)
+                            .count());
+                    stats.service.record(service);
+                    if (timed) {
+                        stats.latency.record(static_cast<uint64_t>(
+                            chrono::duration_cast<chrono::nanoseconds>(
+                                end - arrival)
+                                .count()));
+                    } else {
+                        stats.latency.record_corrected(service,
+                                                       expected_interval);
+                    }
+                    if (!hit) {
+                        stats.misses++;
+                    }
+
+                    Clock::time_point first = timed ? arrival : begin;
+                    if (!result.active[p] || first < result.first[p]) {
+                        result.first[p] = first;
+                    }
+                    result.last[p] = end;
+                    result.active[p] = true;
+                }
+            }
+        }));
+    }
+    for (size_t c = 0; c < clients; c++) {
+        threads[c].join();
+    }
+
+    DriverReport report;
+    for (int p = 0; p < DriverReport::PHASES; p++) {
+        bool active = false;
+        Clock::time_point first, last;
+        for (size_t c = 0; c < clients; c++) {
+            const ClientResult &result = results[c];
+            for (int t = 0; t < DriverReport::TYPES; t++) {
+                report.stats[p][t].merge(result.stats[p][t]);
+            }
+            if (!result.active[p]) {
+                continue;
+            }
+            if (!active || result.first[p] < first) {
+                first = result.first[p];
+            }
+            if (!active || result.last[p] > last) {
+                last = result.last[p];
+            }
+            active = true;
+        }
+        if (active) {
+            report.elapsed[p] = chrono::duration<double>(last - first).count();
+        }
+    }
+    return report;
+}
+
+} // namespace driver
+} // namespace loadgen
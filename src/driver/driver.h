@@ -0,0 +1,107 @@
+#ifndef LOADGEN_DRIVER_DRIVER_H
+#define LOADGEN_DRIVER_DRIVER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "kv_adapter.h"
+#include "latency_histogram.h"
+#include "../request/request_generator.h"
+#include "../types/types.h"
+
+namespace loadgen {
+namespace driver {
+
+/// Options of a Driver run, read from the `driver` table of the TOML file.
+struct DriverOptions {
+    /// Client threads issuing requests.
+    int clients = 1;
+    /// "CLOSED": a client issues its next request when the previous one
+    /// completes. "OPEN": operations arrive at `rate` whether or not earlier
+    /// ones completed, and their latency is measured from the scheduled
+    /// arrival. "WORKLOAD": operations arrive at the times of the
+    /// workload's arrival schedule (RequestGenerator::arrival_ns()), latency
+    /// measured as for OPEN. The loading phase always runs closed-loop.
+    std::string arrival = "CLOSED";
+    /// Operations per second over all clients (OPEN only).
+    double rate = 0;
+    /// Expected time between two requests of a closed-loop client, in
+    /// nanoseconds. When set, closed-loop latencies above it are corrected
+    /// for coordinated omission (LatencyHistogram::record_corrected).
+    long expected_interval_ns = 0;
+    /// Requests a closed-loop client takes from the generator at once.
+    long batch_size = 64;
+    /// Stop after this many seconds; 0 runs the whole workload.
+    double max_duration_s = 0;
+    /// Store of `gen run`: "HASH_MAP" or "ORDERED_MAP".
+    std::string adapter = "HASH_MAP";
+    /// "SHARED": clients take requests from the generator under a lock.
+    /// "INTERLEAVED" or "RANGES": each client drives its own RequestStream
+    /// (RequestGenerator::make_streams()) with that insert key layout.
+    std::string streams = "SHARED";
+    /// Requests a background thread generates ahead of SHARED clients (see
+    /// workload::RequestPrefetcher); 0 generates them on the client threads.
+    long prefetch = 0;
+    /// Unacknowledged inserts the prefetch thread may hand out, which
+    /// bounds how far LATEST reads lag behind the store.
+    long prefetch_pending = 1024;
+};
+
+/// Read the `driver` table of the TOML file (every key is optional).
+DriverOptions load_driver_options(const std::string &config_path);
+
+/// Latencies and outcomes of one (phase, operation type).
+struct OperationStats {
+    /// Response time: from the scheduled arrival in OPEN and WORKLOAD
+    /// modes, corrected with expected_interval_ns in CLOSED mode.
+    LatencyHistogram latency;
+    /// Time spent in the adapter call alone.
+    LatencyHistogram service;
+    /// Reads, deletes and scans that found nothing (multi-gets that found
+    /// none of their keys).
+    uint64_t misses = 0;
+
+    void merge(const OperationStats &other);
+};
+
+/// Merged statistics of a Driver run.
+struct DriverReport {
+    static const int PHASES = 2;
+    static const int TYPES = 7;
+
+    OperationStats stats[PHASES][TYPES];
+    /// Wall time of each phase, in seconds.
+    double elapsed[PHASES] = {0, 0};
+
+    OperationStats &at(workload::RequestGenerator::Phase phase,
+                       loadgen::types::Type type);
+    const OperationStats &at(workload::RequestGenerator::Phase phase,
+                             loadgen::types::Type type) const;
+
+    /// Human-readable summary, latencies in microseconds.
+    void print(std::ostream &os) const;
+};
+
+/// Runs the requests of a RequestGenerator against a KvAdapter from
+/// `clients` threads.
+///
+/// Clients take requests from the generator under a lock, or from their own
+/// stream, and acknowledge inserts once the adapter completed them, so reads
+/// never target keys the store has not seen yet.
+class Driver {
+public:
+    explicit Driver(const DriverOptions &options);
+
+    /// Run the remaining requests of `generator` (or until max_duration_s).
+    DriverReport run(workload::RequestGenerator &generator,
+                     KvAdapter &adapter);
+
+private:
+    DriverOptions options_;
+};
+
+} // namespace driver
+} // namespace loadgen
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef LOADGEN_DRIVER_KV_ADAPTER_H
+#define LOADGEN_DRIVER_KV_ADAPTER_H
+
+#include <cstddef>
+#include <string>
+
+namespace loadgen {
+namespace driver {
+
+/// Store under test. One adapter is shared by every client thread of a
+/// Driver, so implementations must be thread-safe.
+class KvAdapter {
+public:
+    virtual ~KvAdapter() {}
+
+    /// Read `key` into `value`.
+    /// @return false when the key does not exist.
+    virtual bool get(long key, std::string &value) = 0;
+
+    /// Insert or overwrite `key`.
+    virtual void put(long key, const char *value, size_t length) = 0;
+
+    /// Delete `key`.
+    /// @return false when the key does not exist.
+    virtual bool remove(long key) = 0;
+
+    /// Read the `count` keys of `keys`. Reads them one by one with get()
+    /// unless the store has a batched read.
+    /// @return Number of keys found.
+    virtual long multi_get(const long *keys, long count) {
+        long found = 0;
+        std::string value;
+        for (long i = 0; i < count; i++) {
+            if (get(keys[i], value)) {
+                found++;
+            }
+        }
+        return found;
+    }
+
+    /// Read up to `count` consecutive keys starting at `start`.
+    /// @return Number of records read.
+    virtual long scan(long start, long count) = 0;
+};
+
+} // namespace driver
+} // namespace loadgen
+
+#endif
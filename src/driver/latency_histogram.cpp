@@ -0,0 +1,126 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace loadgen {
+namespace driver {
+using namespace std;
+
+const int LatencyHistogram::SUB_BUCKET_BITS;
+const uint64_t LatencyHistogram::SUB_BUCKETS;
+const uint64_t LatencyHistogram::MAX_VALUE;
+
+// ────────────────────────────────────────────────────────────────────────
+// Bucket layout
+// ────────────────────────────────────────────────────────────────────────
+// Values below 2 * SUB_BUCKETS have their own bucket. Above, a value with
+// its highest bit at position SUB_BUCKET_BITS + e falls in the range of
+// shift e, whose SUB_BUCKETS buckets are (value >> e) - SUB_BUCKETS.
+
+static const int MAX_SHIFT = 40 - LatencyHistogram::SUB_BUCKET_BITS - 1;
+static const size_t BUCKETS =
+    (MAX_SHIFT + 2) * LatencyHistogram::SUB_BUCKETS;
+
+static int highest_bit(uint64_t value) { return 63 - __builtin_clzll(value); }
+
+size_t LatencyHistogram::bucket_of(uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    int shift = highest_bit(value) - SUB_BUCKET_BITS;
+    return static_cast<size_t>((shift + 1) * SUB_BUCKETS +
+                               ((value >> shift) - SUB_BUCKETS));
+}
+
+uint64_t LatencyHistogram::highest_in(size_t index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return index;
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t mantissa = index % SUB_BUCKETS + SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Recording
+// ────────────────────────────────────────────────────────────────────────
+void LatencyHistogram::record(uint64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (counts_.empty()) {
+        counts_.assign(BUCKETS, 0);
+    }
+    uint64_t clamped = std::min(value, MAX_VALUE);
+    counts_[bucket_of(clamped)] += count;
+    count_ += count;
+    min_ = std::min(min_, clamped);
+    max_ = std::max(max_, clamped);
+    sum_ += static_cast<double>(clamped) * count;
+}
+
+void LatencyHistogram::record_corrected(uint64_t value,
+                                        uint64_t expected_interval) {
+    record(value);
+    if (expected_interval == 0 || value <= expected_interval) {
+        return;
+    }
+    for (uint64_t missing = value - expected_interval;
+         missing >= expected_interval; missing -= expected_interval) {
+        record(missing);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    if (other.count_ == 0) {
+        return;
+    }
+    if (counts_.empty()) {
+        counts_.assign(BUCKETS, 0);
+    }
+    for (size_t i = 0; i < BUCKETS; i++) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    sum_ += other.sum_;
+}
+
+void LatencyHistogram::reset() {
+    counts_.clear();
+    count_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Queries
+// ────────────────────────────────────────────────────────────────────────
+double LatencyHistogram::mean() const {
+    return count_ ? sum_ / static_cast<double>(count_) : 0;
+}
+
+uint64_t LatencyHistogram::percentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    double clamped = std::max(0.0, std::min(100.0, percentile));
+    uint64_t target = static_cast<uint64_t>(
+        ceil(clamped / 100.0 * static_cast<double>(count_)));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); i++) {
+        seen += counts_[i];
+        if (seen >= target) {
+            return std::min(highest_in(i), max_);
+        }
+    }
+    return max_;
+}
+
+} // namespace driver
+} // namespace loadgen
@@ -0,0 +1,65 @@
+#ifndef LOADGEN_DRIVER_LATENCY_HISTOGRAM_H
+#define LOADGEN_DRIVER_LATENCY_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace loadgen {
+namespace driver {
+
+/// Log-linear latency histogram in the style of HdrHistogram.
+///
+/// Values are nanoseconds. Every power-of-two range is split into
+/// SUB_BUCKETS linear buckets, so recorded values keep a relative precision
+/// of 1/SUB_BUCKETS (under 1%) up to MAX_VALUE; larger values are clamped.
+/// Buckets are allocated on the first record.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 7;
+    static const uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+    /// Largest value tracked exactly (about 18 minutes).
+    static const uint64_t MAX_VALUE = (1ULL << 40) - 1;
+
+    /// Record one occurrence of `value`.
+    void record(uint64_t value) { record(value, 1); }
+
+    /// Record `count` occurrences of `value`.
+    void record(uint64_t value, uint64_t count);
+
+    /// Record `value` and, when it exceeds `expected_interval`, the samples
+    /// a closed-loop client missed while it was blocked: value - interval,
+    /// value - 2 * interval, ... down to `expected_interval` (coordinated
+    /// omission correction, as HdrHistogram's recordValueWithExpectedInterval).
+    void record_corrected(uint64_t value, uint64_t expected_interval);
+
+    /// Add the samples of `other`.
+    void merge(const LatencyHistogram &other);
+
+    void reset();
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    /// Smallest recorded value v such that `percentile` percent of the
+    /// samples are <= v (up to the bucket precision).
+    uint64_t percentile(double percentile) const;
+
+private:
+    static size_t bucket_of(uint64_t value);
+    /// Largest value that falls in bucket `index`.
+    static uint64_t highest_in(size_t index);
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+    double sum_ = 0;
+};
+
+} // namespace driver
+} // namespace loadgen
+
+#endif
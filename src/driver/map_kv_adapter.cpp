@@ -0,0 +1,104 @@
+#include "map_kv_adapter.h"
+
+#include <stdexcept>
+
+namespace loadgen {
+namespace driver {
+using namespace std;
+
+// ────────────────────────────────────────────────────────────────────────
+// HashMapKvAdapter
+// ────────────────────────────────────────────────────────────────────────
+bool HashMapKvAdapter::get(long key, std::string &value) {
+    Stripe &s = stripe(key);
+    lock_guard<mutex> lock(s.mutex);
+    unordered_map<long, string>::const_iterator it = s.map.find(key);
+    if (it == s.map.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+void HashMapKvAdapter::put(long key, const char *value, size_t length) {
+    Stripe &s = stripe(key);
+    lock_guard<mutex> lock(s.mutex);
+    s.map[key].assign(value, length);
+}
+
+bool HashMapKvAdapter::remove(long key) {
+    Stripe &s = stripe(key);
+    lock_guard<mutex> lock(s.mutex);
+    return s.map.erase(key) > 0;
+}
+
+long HashMapKvAdapter::scan(long start, long count) {
+    long found = 0;
+    string value;
+    for (long key = start; key < start + count; key++) {
+        if (get(key, value)) {
+            found++;
+        }
+    }
+    return found;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// OrderedMapKvAdapter
+// ────────────────────────────────────────────────────────────────────────
+bool OrderedMapKvAdapter::get(long key, std::string &value) {
+    lock_guard<mutex> lock(mutex_);
+    map<long, string>::const_iterator it = map_.find(key);
+    if (it == map_.end()) {
+        return false;
+    }
+    value = it->second;
+    return true;
+}
+
+void OrderedMapKvAdapter::put(long key, const char *value, size_t length) {
+    lock_guard<mutex> lock(mutex_);
+    map_[key].assign(value, length);
+}
+
+bool OrderedMapKvAdapter::remove(long key) {
+    lock_guard<mutex> lock(mutex_);
+    return map_.erase(key) > 0;
+}
+
+long OrderedMapKvAdapter::multi_get(const long *keys, long count) {
+    lock_guard<mutex> lock(mutex_);
+    long found = 0;
+    string value;
+    for (long i = 0; i < count; i++) {
+        map<long, string>::const_iterator it = map_.find(keys[i]);
+        if (it != map_.end()) {
+            value = it->second;
+            found++;
+        }
+    }
+    return found;
+}
+
+long OrderedMapKvAdapter::scan(long start, long count) {
+    lock_guard<mutex> lock(mutex_);
+    long found = 0;
+    string value;
+    for (map<long, string>::const_iterator it = map_.lower_bound(start);
+         it != map_.end() && found < count; ++it, ++found) {
+        value = it->second;
+    }
+    return found;
+}
+
+unique_ptr<KvAdapter> make_map_kv_adapter(const std::string &name) {
+    if (name == "HASH_MAP") {
+        return unique_ptr<KvAdapter>(new HashMapKvAdapter());
+    } else if (name == "ORDERED_MAP") {
+        return unique_ptr<KvAdapter>(new OrderedMapKvAdapter());
+    }
+    throw invalid_argument("Unknown driver adapter: " + name);
+}
+
+} // namespace driver
+} // namespace loadgen
@@ -0,0 +1,60 @@
+#ifndef LOADGEN_DRIVER_MAP_KV_ADAPTER_H
+#define LOADGEN_DRIVER_MAP_KV_ADAPTER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "kv_adapter.h"
+
+namespace loadgen {
+namespace driver {
+
+/// In-process hash map store, striped over STRIPES locks. Scans look keys
+/// up one by one, which matches the dense integer keys of the generator.
+class HashMapKvAdapter : public KvAdapter {
+public:
+    static const size_t STRIPES = 64;
+
+    bool get(long key, std::string &value) override;
+    void put(long key, const char *value, size_t length) override;
+    bool remove(long key) override;
+    long scan(long start, long count) override;
+
+private:
+    struct Stripe {
+        std::mutex mutex;
+        std::unordered_map<long, std::string> map;
+    };
+
+    Stripe &stripe(long key) {
+        return stripes_[static_cast<unsigned long>(key) % STRIPES];
+    }
+
+    Stripe stripes_[STRIPES];
+};
+
+/// In-process ordered map store behind a single lock; scans iterate the
+/// map and multi-gets take the lock once.
+class OrderedMapKvAdapter : public KvAdapter {
+public:
+    bool get(long key, std::string &value) override;
+    void put(long key, const char *value, size_t length) override;
+    bool remove(long key) override;
+    long multi_get(const long *keys, long count) override;
+    long scan(long start, long count) override;
+
+private:
+    std::mutex mutex_;
+    std::map<long, std::string> map_;
+};
+
+/// Adapter named `name`: "HASH_MAP" or "ORDERED_MAP".
+std::unique_ptr<KvAdapter> make_map_kv_adapter(const std::string &name);
+
+} // namespace driver
+} // namespace loadgen
+
+#endif
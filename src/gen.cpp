@@ -1,11 +1,51 @@
 #include <stdlib.h>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "driver/driver.h"
+#include "driver/map_kv_adapter.h"
+#include "request/generator_metrics.h"
 #include "request/request_generator.h"
 
+// Usage: gen <config.toml>      export the workload trace
+//        gen run <config.toml>  run the workload against an in-process store
+//        gen range <config.toml> <begin> <end> <file>
+//                               export requests [begin, end) of the trace
 int main(int argc, char const *argv[]) {
     if (argc < 2) {
         exit(1);
     }
 
+    if (std::string(argv[1]) == "run") {
+        if (argc < 3) {
+            exit(1);
+        }
+        using namespace loadgen::driver;
+        workload::RequestGenerator generator(argv[2]);
+        DriverOptions options = load_driver_options(argv[2]);
+        std::unique_ptr<KvAdapter> adapter =
+            make_map_kv_adapter(options.adapter);
+        std::unique_ptr<workload::MetricsReporter> reporter =
+            workload::make_metrics_reporter(generator.metrics(),
+                                            generator.config());
+        DriverReport report = Driver(options).run(generator, *adapter);
+        if (reporter) {
+            reporter->stop();
+        }
+        report.print(std::cout);
+        return 0;
+    }
+
+    if (std::string(argv[1]) == "range") {
+        if (argc < 6) {
+            exit(1);
+        }
+        workload::RequestGenerator generator(argv[2]);
+        generator.generate_range_to_file(argv[5], atol(argv[3]),
+                                         atol(argv[4]));
+        return 0;
+    }
+
     workload::RequestGenerator generator(argv[1]);
     generator.generate_to_file();
 
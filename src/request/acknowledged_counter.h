@@ -1,40 +1,136 @@
 #ifndef RFUNC_ACKNOWLEDGED_COUNTER_H
 #define RFUNC_ACKNOWLEDGED_COUNTER_H
 
-#include <cmath>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+#include <vector>
 
+/// Insert key sequence shared by the writers and the readers of a workload,
+/// safe to use from any number of threads without locks.
+///
+/// next() hands out insert keys. Writers acknowledge() a key once its insert
+/// has completed, in any order; last_value() is the highest key such that it
+/// and every key below it are acknowledged, so readers bounded by it never
+/// target an insert still in flight (YCSB's AcknowledgedCounterGenerator).
+///
+/// Acknowledged keys above last_value() are kept in a ring bitmap of
+/// `window` bits; acknowledging a key more than `window` keys past
+/// last_value() throws. Generators that acknowledge every insert as soon as
+/// they draw it never have more than one key outstanding.
+///
+/// With a `stride`, the sequence is count_start, count_start + stride, ...,
+/// so several counters can hand out interleaved keys.
 template <typename _IntType = int> class acknowledged_counter {
 
 public:
+    /// Window of YCSB's AcknowledgedCounterGenerator.
+    static const size_t DEFAULT_WINDOW = 1 << 20;
+
     _IntType operator()() { return next(); }
 
-    acknowledged_counter(_IntType count_start) {
-        counter_ = count_start;
-        limit_ = count_start - 1;
+    /// @param count_start  First key handed out; last_value() starts at
+    ///                     count_start - stride.
+    /// @param window       Outstanding acknowledgements tracked, rounded up
+    ///                     to a power of two of at least 64.
+    /// @param stride       Distance between consecutive keys.
+    explicit acknowledged_counter(_IntType count_start,
+                                  size_t window = DEFAULT_WINDOW,
+                                  _IntType stride = 1) :
+        counter_(count_start), limit_(count_start - stride), stride_(stride),
+        window_(round_window(window)), words_(window_ / 64) {
+        if (stride < 1) {
+            throw std::invalid_argument("acknowledged_counter stride < 1");
+        }
     }
 
-    acknowledged_counter(acknowledged_counter &other) {
-        counter_ = other.count_start;
-        limit_ = other.limit_;
-    }
+    acknowledged_counter(const acknowledged_counter &) = delete;
+    acknowledged_counter &operator=(const acknowledged_counter &) = delete;
 
-    _IntType next() { return counter_++; }
+    _IntType next() {
+        return counter_.fetch_add(stride_, std::memory_order_relaxed);
+    }
 
     void acknowledge(_IntType value) {
-        // ycsb like acknowledgement window mechanism is not adequate on pre
-        // generated workload
-        if (value > limit_) {
-            limit_ = value;
+        _IntType limit = limit_.load();
+        if (value <= limit) {
+            return;
+        }
+        if (static_cast<uint64_t>((value - limit) / stride_) > window_) {
+            throw std::runtime_error(
+                "Too many unacknowledged insert keys (ack_window)");
         }
+        uint64_t slot = this->slot(value);
+        words_[slot >> 6].fetch_or(uint64_t(1) << (slot & 63));
+        advance();
     }
 
-    _IntType last_value() { return limit_; }
+    _IntType last_value() const { return limit_.load(); }
 
-public:
-    _IntType counter_;
+    /// Key the next call to next() hands out.
+    _IntType peek() const { return counter_.load(); }
+
+    /// Restart the sequence at `count_start` with nothing outstanding. Not
+    /// safe while other threads use the counter.
+    void restart(_IntType count_start) {
+        restart(count_start, count_start - stride_);
+    }
+
+    /// Restart the sequence at `count_start`, with `last_value` as the last
+    /// acknowledged key and the keys between them still pending. Not safe
+    /// while other threads use the counter.
+    void restart(_IntType count_start, _IntType last_value) {
+        counter_.store(count_start);
+        limit_.store(last_value);
+        for (size_t i = 0; i < words_.size(); i++) {
+            words_[i].store(0);
+        }
+    }
+
+private:
+    /// Keys of the sequence are congruent modulo the stride, so consecutive
+    /// ones fall in consecutive slots.
+    uint64_t slot(_IntType value) const {
+        return static_cast<uint64_t>(value) / static_cast<uint64_t>(stride_) &
+               (window_ - 1);
+    }
+
+    static size_t round_window(size_t window) {
+        size_t bits = 64;
+        while (bits < window) {
+            bits <<= 1;
+        }
+        return bits;
+    }
+
+    /// Move last_value() over every acknowledged key that follows it.
+    ///
+    /// A thread claims the bit of limit + stride before moving the limit. If
+    /// the limit moved in between, the bit belongs to the key one window
+    /// later and is put back. Every operation is sequentially consistent, so an
+    /// acknowledgement either sees the limit that makes its key next or is
+    /// seen by the thread that moved the limit there.
+    void advance() {
+        for (;;) {
+            _IntType limit = limit_.load();
+            uint64_t slot = this->slot(limit + stride_);
+            uint64_t bit = uint64_t(1) << (slot & 63);
+            std::atomic<uint64_t> &word = words_[slot >> 6];
+            if (!(word.fetch_and(~bit) & bit)) {
+                return;
+            }
+            if (!limit_.compare_exchange_strong(limit, limit + stride_)) {
+                word.fetch_or(bit);
+            }
+        }
+    }
 
-    _IntType limit_;
+    std::atomic<_IntType> counter_;
+    std::atomic<_IntType> limit_;
+    _IntType stride_;
+    size_t window_;
+    std::vector<std::atomic<uint64_t>> words_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,102 @@
+#include "arrival_process.h"
+#include "counter_engine.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+ArrivalProcess::ArrivalProcess(const RequestGenerator::Configuration &config) :
+    poisson_(config.arrival != "CONSTANT"),
+    seed_(static_cast<uint64_t>(config.arrival_seed)) {
+    // (start, rate) points, each rate holding until the next point.
+    vector<pair<double, double>> points;
+    if (config.arrival == "CONSTANT" || config.arrival == "POISSON") {
+        points.push_back(make_pair(0.0, config.arrival_rate));
+    } else if (config.arrival == "ON_OFF") {
+        if (config.arrival_on_ms <= 0 || config.arrival_off_ms < 0) {
+            throw invalid_argument("ON_OFF arrival needs a positive "
+                                   "arrival_on_ms and arrival_off_ms >= 0");
+        }
+        period_ = (config.arrival_on_ms + config.arrival_off_ms) / 1e3;
+        period_arrivals_ = config.arrival_rate * config.arrival_on_ms / 1e3;
+        points.push_back(make_pair(0.0, config.arrival_rate));
+    } else if (config.arrival == "CURVE") {
+        points = config.arrival_curve;
+    } else {
+        throw invalid_argument("Unknown arrival: " + config.arrival);
+    }
+
+    if (points.empty() || !(points.back().second > 0)) {
+        throw invalid_argument("The last arrival rate must be positive");
+    }
+    // Stretches without arrivals are skipped by starting the next segment
+    // with the same expected arrivals.
+    double arrivals = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+        double start = points[i].first, rate = points[i].second;
+        if (start < 0 || rate < 0 ||
+            (i > 0 && !(start > points[i - 1].first))) {
+            throw invalid_argument("arrival_curve needs increasing start "
+                                   "times and non-negative rates");
+        }
+        if (i > 0) {
+            arrivals += points[i - 1].second * (start - points[i - 1].first);
+        }
+        if (rate > 0) {
+            Segment segment = {start, rate, arrivals};
+            segments_.push_back(segment);
+        }
+    }
+}
+
+uint64_t ArrivalProcess::gap(long index) const {
+    if (!poisson_) {
+        return UNIT;
+    }
+    rfunc::counter_engine engine(seed_, static_cast<uint64_t>(index));
+    // 53 random bits in [0, 1).
+    double u = static_cast<double>(engine() >> 11) / 9007199254740992.0;
+    return static_cast<uint64_t>(llround(-log1p(-u) * UNIT));
+}
+
+uint64_t ArrivalProcess::gaps(long begin, long end) const {
+    if (end <= begin) {
+        return 0;
+    }
+    if (!poisson_) {
+        return static_cast<uint64_t>(end - begin) * UNIT;
+    }
+    uint64_t sum = 0;
+    for (long i = begin; i < end; i++) {
+        sum += gap(i);
+    }
+    return sum;
+}
+
+uint64_t ArrivalProcess::time_ns(uint64_t arrivals) const {
+    double a = static_cast<double>(arrivals) / UNIT;
+    double base = 0;
+    if (period_ > 0) {
+        double periods = floor(a / period_arrivals_);
+        base = periods * period_;
+        a -= periods * period_arrivals_;
+    }
+    // Last segment that starts with at most `a` expected arrivals.
+    size_t lo = 0, hi = segments_.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (segments_[mid].arrivals <= a) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    const Segment &segment = segments_[lo];
+    double seconds =
+        base + segment.start + (a - segment.arrivals) / segment.rate;
+    return static_cast<uint64_t>(llround(seconds * 1e9));
+}
+
+} // namespace workload
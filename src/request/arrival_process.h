@@ -0,0 +1,60 @@
+#ifndef WORKLOAD_ARRIVAL_PROCESS_H
+#define WORKLOAD_ARRIVAL_PROCESS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "request_generator.h"
+
+namespace workload {
+
+/// Intended issue times of the operations (`workload.arrival`).
+///
+/// Operation i arrives once the expected number of arrivals since the first
+/// operation reaches the sum of the gaps of the operations before it. Gaps
+/// are one arrival for CONSTANT and exponential for the Poisson processes
+/// (POISSON, ON_OFF and CURVE), drawn from counter_engine(arrival_seed, i),
+/// so each one only depends on its operation index. They are summed in fixed
+/// point, which makes the times independent of how the operations are split
+/// into chunks or batches.
+class ArrivalProcess {
+public:
+    /// Fixed-point units of one expected arrival.
+    static const uint64_t UNIT = 1ULL << 24;
+
+    /// @throws std::invalid_argument for unknown processes and rates that
+    /// never let the next operation arrive.
+    explicit ArrivalProcess(const RequestGenerator::Configuration &config);
+
+    /// Gap between operation `index` and the next one, in UNITs.
+    uint64_t gap(long index) const;
+
+    /// Sum of the gaps of operations [begin, end): constant time for
+    /// CONSTANT, one draw per operation for the Poisson processes.
+    uint64_t gaps(long begin, long end) const;
+
+    /// Nanoseconds from the first operation until `arrivals` UNITs of
+    /// arrivals are expected.
+    uint64_t time_ns(uint64_t arrivals) const;
+
+private:
+    /// From `start` seconds on, `rate` arrivals per second.
+    struct Segment {
+        double start;
+        double rate;
+        /// Expected arrivals before `start`.
+        double arrivals;
+    };
+
+    bool poisson_;
+    uint64_t seed_;
+    std::vector<Segment> segments_;
+    /// ON_OFF: length of one on and off period, in seconds, and its
+    /// expected arrivals; 0 for the other processes.
+    double period_ = 0;
+    double period_arrivals_ = 0;
+};
+
+} // namespace workload
+
+#endif
@@ -0,0 +1,241 @@
+#include "binary_trace_format.h"
+
+namespace workload {
+namespace binary_trace {
+
+static void put_string(std::string &out, const std::string &value) {
+    put_varint(out, value.size());
+    out += value;
+}
+
+static void put_long(std::string &out, long value) {
+    put_varint(out, zigzag(value));
+}
+
+static const char *get_string(const char *p, const char *end,
+                              std::string &value) {
+    uint64_t length;
+    p = get_varint(p, end, length);
+    if (static_cast<uint64_t>(end - p) < length) {
+        throw std::runtime_error("Truncated string in binary trace header");
+    }
+    value.assign(p, length);
+    return p + length;
+}
+
+template <typename T>
+static const char *get_long(const char *p, const char *end, T &value) {
+    uint64_t raw;
+    p = get_varint(p, end, raw);
+    value = static_cast<T>(unzigzag(raw));
+    return p;
+}
+
+static const char *get_double(const char *p, const char *end,
+                              double &value) {
+    if (end - p < 8) {
+        throw std::runtime_error("Truncated double in binary trace header");
+    }
+    value = get_double(p);
+    return p + 8;
+}
+
+void put_configuration(std::string &out,
+                       const RequestGenerator::Configuration &config) {
+    out.push_back(config.gen_values ? 1 : 0);
+    put_long(out, config.value_min_size);
+    put_long(out, config.value_max_size);
+    put_long(out, config.key_seed);
+    put_long(out, config.operation_seed);
+    put_long(out, config.scan_seed);
+    put_long(out, config.value_seed);
+    put_long(out, config.n_records);
+    put_long(out, config.n_operations);
+    put_string(out, config.data_distribution);
+    put_double(out, config.read_proportion);
+    put_double(out, config.update_proportion);
+    put_double(out, config.insert_proportion);
+    put_double(out, config.scan_proportion);
+    put_string(out, config.scan_length_distribution);
+    put_long(out, config.min_scan_length);
+    put_long(out, config.max_scan_length);
+    put_string(out, config.rng_mode);
+    put_string(out, config.rng_engine);
+    // Fields below were added after version 1; readers keep the defaults
+    // of the fields a header ends before.
+    put_string(out, config.zipfian_zeta);
+    put_string(out, config.value_generator);
+    put_long(out, config.value_pool_size);
+    put_double(out, config.value_compression_ratio);
+    put_double(out, config.delete_proportion);
+    put_double(out, config.read_modify_write_proportion);
+    put_double(out, config.multi_get_proportion);
+    put_long(out, config.multi_get_seed);
+    put_string(out, config.multi_get_size_distribution);
+    put_long(out, config.min_multi_get_size);
+    put_long(out, config.max_multi_get_size);
+    put_string(out, config.operation_mixer);
+    out.push_back(config.live_keys ? 1 : 0);
+    put_string(out, config.hotspot_drift);
+    put_long(out, config.hotspot_drift_interval);
+    put_long(out, config.hotspot_drift_step);
+    put_string(out, config.arrival);
+    put_double(out, config.arrival_rate);
+    put_long(out, config.arrival_seed);
+    put_long(out, config.arrival_on_ms);
+    put_long(out, config.arrival_off_ms);
+    put_varint(out, config.arrival_curve.size());
+    for (size_t i = 0; i < config.arrival_curve.size(); i++) {
+        put_double(out, config.arrival_curve[i].first);
+        put_double(out, config.arrival_curve[i].second);
+    }
+    put_string(out, config.zipfian_scramble);
+    put_string(out, config.insert_order);
+    put_string(out, config.key_encoding);
+    put_long(out, config.key_width);
+    put_string(out, config.key_size_distribution);
+    put_long(out, config.key_min_size);
+    put_long(out, config.key_max_size);
+    put_string(out, config.key_sampling);
+    put_long(out, config.ack_window);
+    put_varint(out, config.phases.size());
+    for (size_t i = 0; i < config.phases.size(); i++) {
+        const RequestGenerator::PhaseConfiguration &phase = config.phases[i];
+        put_string(out, phase.name);
+        put_long(out, phase.n_operations);
+        put_long(out, phase.duration_ms);
+        put_string(out, phase.data_distribution);
+        put_double(out, phase.read_proportion);
+        put_double(out, phase.update_proportion);
+        put_double(out, phase.insert_proportion);
+        put_double(out, phase.scan_proportion);
+        put_double(out, phase.delete_proportion);
+        put_double(out, phase.read_modify_write_proportion);
+        put_double(out, phase.multi_get_proportion);
+        put_string(out, phase.scan_length_distribution);
+        put_long(out, phase.min_scan_length);
+        put_long(out, phase.max_scan_length);
+        put_string(out, phase.multi_get_size_distribution);
+        put_long(out, phase.min_multi_get_size);
+        put_long(out, phase.max_multi_get_size);
+        out.push_back(phase.gen_values ? 1 : 0);
+        put_long(out, phase.value_min_size);
+        put_long(out, phase.value_max_size);
+    }
+}
+
+void get_configuration(const char *p, const char *end,
+                       RequestGenerator::Configuration &config) {
+    if (p == end) {
+        throw std::runtime_error("Truncated binary trace header");
+    }
+    config.gen_values = *p++ != 0;
+    p = get_long(p, end, config.value_min_size);
+    p = get_long(p, end, config.value_max_size);
+    p = get_long(p, end, config.key_seed);
+    p = get_long(p, end, config.operation_seed);
+    p = get_long(p, end, config.scan_seed);
+    p = get_long(p, end, config.value_seed);
+    p = get_long(p, end, config.n_records);
+    p = get_long(p, end, config.n_operations);
+    p = get_string(p, end, config.data_distribution);
+    p = get_double(p, end, config.read_proportion);
+    p = get_double(p, end, config.update_proportion);
+    p = get_double(p, end, config.insert_proportion);
+    p = get_double(p, end, config.scan_proportion);
+    p = get_string(p, end, config.scan_length_distribution);
+    p = get_long(p, end, config.min_scan_length);
+    p = get_long(p, end, config.max_scan_length);
+    p = get_string(p, end, config.rng_mode);
+    p = get_string(p, end, config.rng_engine);
+    if (p < end) {
+        p = get_string(p, end, config.zipfian_zeta);
+    }
+    if (p < end) {
+        p = get_string(p, end, config.value_generator);
+        p = get_long(p, end, config.value_pool_size);
+        p = get_double(p, end, config.value_compression_ratio);
+    }
+    if (p < end) {
+        p = get_double(p, end, config.delete_proportion);
+        p = get_double(p, end, config.read_modify_write_proportion);
+        p = get_double(p, end, config.multi_get_proportion);
+        p = get_long(p, end, config.multi_get_seed);
+        p = get_string(p, end, config.multi_get_size_distribution);
+        p = get_long(p, end, config.min_multi_get_size);
+        p = get_long(p, end, config.max_multi_get_size);
+        p = get_string(p, end, config.operation_mixer);
+    }
+    if (p < end) {
+        config.live_keys = *p++ != 0;
+    }
+    if (p < end) {
+        p = get_string(p, end, config.hotspot_drift);
+        p = get_long(p, end, config.hotspot_drift_interval);
+        p = get_long(p, end, config.hotspot_drift_step);
+    }
+    if (p < end) {
+        p = get_string(p, end, config.arrival);
+        p = get_double(p, end, config.arrival_rate);
+        p = get_long(p, end, config.arrival_seed);
+        p = get_long(p, end, config.arrival_on_ms);
+        p = get_long(p, end, config.arrival_off_ms);
+        uint64_t points;
+        p = get_varint(p, end, points);
+        config.arrival_curve.clear();
+        for (uint64_t i = 0; i < points; i++) {
+            double start, rate;
+            p = get_double(p, end, start);
+            p = get_double(p, end, rate);
+            config.arrival_curve.push_back(std::make_pair(start, rate));
+        }
+    }
+    if (p < end) {
+        p = get_string(p, end, config.zipfian_scramble);
+        p = get_string(p, end, config.insert_order);
+    }
+    if (p < end) {
+        p = get_string(p, end, config.key_encoding);
+        p = get_long(p, end, config.key_width);
+        p = get_string(p, end, config.key_size_distribution);
+        p = get_long(p, end, config.key_min_size);
+        p = get_long(p, end, config.key_max_size);
+    }
+    if (p < end) {
+        p = get_string(p, end, config.key_sampling);
+        p = get_long(p, end, config.ack_window);
+        uint64_t phases;
+        p = get_varint(p, end, phases);
+        config.phases.clear();
+        for (uint64_t i = 0; i < phases; i++) {
+            RequestGenerator::PhaseConfiguration phase;
+            p = get_string(p, end, phase.name);
+            p = get_long(p, end, phase.n_operations);
+            p = get_long(p, end, phase.duration_ms);
+            p = get_string(p, end, phase.data_distribution);
+            p = get_double(p, end, phase.read_proportion);
+            p = get_double(p, end, phase.update_proportion);
+            p = get_double(p, end, phase.insert_proportion);
+            p = get_double(p, end, phase.scan_proportion);
+            p = get_double(p, end, phase.delete_proportion);
+            p = get_double(p, end, phase.read_modify_write_proportion);
+            p = get_double(p, end, phase.multi_get_proportion);
+            p = get_string(p, end, phase.scan_length_distribution);
+            p = get_long(p, end, phase.min_scan_length);
+            p = get_long(p, end, phase.max_scan_length);
+            p = get_string(p, end, phase.multi_get_size_distribution);
+            p = get_long(p, end, phase.min_multi_get_size);
+            p = get_long(p, end, phase.max_multi_get_size);
+            if (p == end) {
+                throw std::runtime_error("Truncated binary trace header");
+            }
+            phase.gen_values = *p++ != 0;
+            p = get_long(p, end, phase.value_min_size);
+            p = get_long(p, end, phase.value_max_size);
+            config.phases.push_back(phase);
+        }
+    }
+}
+
+} // namespace binary_trace
+} // namespace workload
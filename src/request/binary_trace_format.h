@@ -0,0 +1,120 @@
+#ifndef WORKLOAD_BINARY_TRACE_FORMAT_H
+#define WORKLOAD_BINARY_TRACE_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "request_generator.h"
+
+namespace workload {
+namespace binary_trace {
+
+// ── Layout ─────────────────────────────────────────────────────────────
+//
+//   MAGIC | fixed32 version | varint header length | header
+//   block*: fixed32 record count | fixed32 payload length |
+//           fixed64 index of the first record | payload
+//   index:  (fixed64 block offset | fixed64 first record |
+//            fixed32 record count) per block
+//   phases: (optional) fixed32 entry count | (fixed64 first record |
+//           fixed32 phase index | varint name length | name) per entry
+//   footer: fixed64 index offset | fixed64 block count |
+//           fixed64 record count | INDEX_MAGIC
+//
+// The header holds the workload configuration (seeds included). A record is
+// a type byte (loadgen::types::Type, LOADING_FLAG for loading records), the
+// zigzag varint delta of its key from the previous key of the block, then the
+// scan length for SCANs, the key count and the zigzag deltas of the further
+// keys (each from the key before it) for MULTI_GETs, or the value length and
+// bytes for WRITEs and READ_MODIFY_WRITEs. With arrivals, the key of every
+// operation is followed by the zigzag varint delta of its arrival time from
+// the previous operation of the block. Workloads with phases list the first
+// record of every phase in the phase table. Integers are little-endian.
+//
+// Traces with arrivals are version 2, so that version 1 readers reject
+// them; the others are still written as version 1.
+
+const char MAGIC[8] = {'L', 'G', 'T', 'R', 'A', 'C', 'E', '\0'};
+const char INDEX_MAGIC[8] = {'L', 'G', 'I', 'N', 'D', 'E', 'X', '\0'};
+const uint32_t VERSION = 2;
+const uint32_t UNTIMED_VERSION = 1;
+const uint8_t LOADING_FLAG = 0x80;
+const size_t BLOCK_HEADER_SIZE = 16;
+const size_t INDEX_ENTRY_SIZE = 20;
+const size_t FOOTER_SIZE = 32;
+
+inline void put_varint(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline const char *get_varint(const char *p, const char *end,
+                              uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) {
+            throw std::runtime_error("Truncated varint in binary trace");
+        }
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return p;
+        }
+    }
+    throw std::runtime_error("Malformed varint in binary trace");
+}
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^
+           static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void put_fixed(std::string &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+inline uint64_t get_fixed(const char *p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+inline void put_double(std::string &out, double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    put_fixed(out, bits, 8);
+}
+
+inline double get_double(const char *p) {
+    uint64_t bits = get_fixed(p, 8);
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/// Serialize the fields of `config` that define the trace.
+void put_configuration(std::string &out,
+                       const RequestGenerator::Configuration &config);
+
+/// Inverse of put_configuration(); fields absent from the trace keep their
+/// defaults.
+void get_configuration(const char *p, const char *end,
+                       RequestGenerator::Configuration &config);
+
+} // namespace binary_trace
+} // namespace workload
+
+#endif
@@ -0,0 +1,317 @@
+#include "binary_trace_reader.h"
+#include "binary_trace_format.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+using namespace binary_trace;
+
+BinaryTraceReader::BinaryTraceReader(const std::string &path) :
+    in_(path, ifstream::in | ifstream::binary), deriver_(0) {
+    if (!in_) {
+        throw runtime_error("Cannot open binary trace: " + path);
+    }
+
+    char fixed[FOOTER_SIZE];
+    in_.read(fixed, sizeof(MAGIC) + 4);
+    if (!in_ || !equal(MAGIC, MAGIC + sizeof(MAGIC), fixed)) {
+        throw runtime_error("Not a binary trace: " + path);
+    }
+    uint32_t version = static_cast<uint32_t>(get_fixed(fixed + 8, 4));
+    if (version > VERSION) {
+        throw runtime_error("Unsupported binary trace version " +
+                            to_string(version));
+    }
+
+    // Header length varint, read byte by byte.
+    uint64_t header_length = 0;
+    for (int shift = 0;; shift += 7) {
+        int byte = in_.get();
+        if (byte == EOF || shift >= 64) {
+            throw runtime_error("Truncated binary trace header");
+        }
+        header_length |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    string header(header_length, '\0');
+    in_.read(&header[0], header_length);
+    if (!in_) {
+        throw runtime_error("Truncated binary trace header");
+    }
+    get_configuration(header.data(), header.data() + header.size(), config_);
+    derived_values_ = config_.value_generator == "DERIVED";
+    timed_ = config_.arrival != "NONE";
+    deriver_ = ValueDeriver(static_cast<uint64_t>(config_.value_seed));
+
+    in_.seekg(-static_cast<streamoff>(FOOTER_SIZE), ifstream::end);
+    in_.read(fixed, FOOTER_SIZE);
+    if (!in_ || !equal(INDEX_MAGIC, INDEX_MAGIC + sizeof(INDEX_MAGIC),
+                       fixed + 24)) {
+        throw runtime_error("Binary trace has no block index: " + path);
+    }
+    uint64_t index_offset = get_fixed(fixed, 8);
+    uint64_t blocks = get_fixed(fixed + 8, 8);
+    size_ = get_fixed(fixed + 16, 8);
+
+    string index(blocks * INDEX_ENTRY_SIZE, '\0');
+    in_.seekg(static_cast<streamoff>(index_offset));
+    in_.read(&index[0], index.size());
+    if (!in_) {
+        throw runtime_error("Truncated binary trace index");
+    }
+    index_.resize(blocks);
+    for (size_t i = 0; i < blocks; i++) {
+        const char *entry = index.data() + i * INDEX_ENTRY_SIZE;
+        index_[i].offset = get_fixed(entry, 8);
+        index_[i].first = get_fixed(entry + 8, 8);
+        index_[i].count = static_cast<uint32_t>(get_fixed(entry + 16, 4));
+    }
+
+    // Optional phase table between the index and the footer.
+    in_.seekg(0, ifstream::end);
+    uint64_t table_offset = index_offset + index.size();
+    uint64_t table_end = static_cast<uint64_t>(in_.tellg()) - FOOTER_SIZE;
+    if (table_offset < table_end) {
+        string table(table_end - table_offset, '\0');
+        in_.seekg(static_cast<streamoff>(table_offset));
+        in_.read(&table[0], table.size());
+        const char *p = table.data();
+        const char *end = p + table.size();
+        if (!in_ || end - p < 4) {
+            throw runtime_error("Truncated binary trace phase table");
+        }
+        uint32_t count = static_cast<uint32_t>(get_fixed(p, 4));
+        p += 4;
+        for (uint32_t i = 0; i < count; i++) {
+            if (end - p < 12) {
+                throw runtime_error("Truncated binary trace phase table");
+            }
+            TracePhase phase;
+            phase.first = get_fixed(p, 8);
+            phase.index = static_cast<size_t>(get_fixed(p + 8, 4));
+            uint64_t length;
+            p = get_varint(p + 12, end, length);
+            if (static_cast<uint64_t>(end - p) < length) {
+                throw runtime_error("Truncated binary trace phase table");
+            }
+            phase.name.assign(p, length);
+            p += length;
+            phases_.push_back(phase);
+        }
+    }
+}
+
+const RequestGenerator::Configuration &BinaryTraceReader::config() const {
+    return config_;
+}
+
+uint64_t BinaryTraceReader::size() const { return size_; }
+
+uint64_t BinaryTraceReader::block_count() const { return index_.size(); }
+
+void BinaryTraceReader::seek(uint64_t index) {
+    block_.count = 0;
+    position_ = 0;
+    if (index >= size_) {
+        next_block_ = index_.size();
+        return;
+    }
+
+    // Last block whose first record is <= index.
+    size_t lo = 0, hi = index_.size();
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index_[mid].first <= index) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    load_block(lo);
+    next_block_ = lo + 1;
+    position_ = static_cast<size_t>(index - index_[lo].first);
+}
+
+void BinaryTraceReader::load_block(size_t block) {
+    const BlockIndexEntry &entry = index_[block];
+
+    char header[BLOCK_HEADER_SIZE];
+    in_.clear();
+    in_.seekg(static_cast<streamoff>(entry.offset));
+    in_.read(header, BLOCK_HEADER_SIZE);
+    uint32_t count = static_cast<uint32_t>(get_fixed(header, 4));
+    uint32_t length = static_cast<uint32_t>(get_fixed(header + 4, 4));
+    payload_.resize(length);
+    in_.read(&payload_[0], length);
+    if (!in_ || count != entry.count) {
+        throw runtime_error("Corrupted binary trace block");
+    }
+
+    block_.resize(count);
+
+    // Phases starting at or before the current record.
+    size_t phase = 0;
+
+    const char *p = payload_.data();
+    const char *end = p + payload_.size();
+    long key = 0;
+    uint64_t arrival = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (p == end) {
+            throw runtime_error("Truncated binary trace block");
+        }
+        uint8_t tag = static_cast<uint8_t>(*p++);
+        loadgen::types::Type type =
+            static_cast<loadgen::types::Type>(tag & ~LOADING_FLAG);
+        uint64_t raw;
+        p = get_varint(p, end, raw);
+        key += static_cast<long>(unzigzag(raw));
+        block_.arrival_times[i] = 0;
+        if (timed_ && !(tag & LOADING_FLAG)) {
+            p = get_varint(p, end, raw);
+            arrival += static_cast<uint64_t>(unzigzag(raw));
+            block_.arrival_times[i] = arrival;
+        }
+
+        block_.phases[i] = (tag & LOADING_FLAG)
+                               ? RequestGenerator::Phase::LOADING
+                               : RequestGenerator::Phase::OPERATIONS;
+        while (phase < phases_.size() &&
+               phases_[phase].first <= entry.first + i) {
+            phase++;
+        }
+        block_.phase_indices[i] =
+            phase > 0 && !(tag & LOADING_FLAG) ? phases_[phase - 1].index : 0;
+        block_.types[i] = type;
+        block_.keys[i] = key;
+        block_.scan_sizes[i] = 0;
+        block_.value_offsets[i] = block_.values.size();
+        block_.value_lengths[i] = 0;
+        block_.value_versions[i] = 0;
+        block_.key_offsets[i] = block_.multi_get_keys.size();
+
+        if (type == loadgen::types::Type::SCAN) {
+            p = get_varint(p, end, raw);
+            block_.scan_sizes[i] = static_cast<long>(raw);
+        } else if (type == loadgen::types::Type::MULTI_GET) {
+            p = get_varint(p, end, raw);
+            block_.scan_sizes[i] = static_cast<long>(raw);
+            long previous = key;
+            block_.multi_get_keys.push_back(previous);
+            for (uint64_t k = 1; k < raw; k++) {
+                uint64_t delta;
+                p = get_varint(p, end, delta);
+                previous += static_cast<long>(unzigzag(delta));
+                block_.multi_get_keys.push_back(previous);
+            }
+        } else if ((type == loadgen::types::Type::WRITE ||
+                    type == loadgen::types::Type::READ_MODIFY_WRITE) &&
+                   config_.gen_values) {
+            p = get_varint(p, end, raw);
+            block_.value_lengths[i] = raw;
+            if (derived_values_) {
+                uint64_t version;
+                p = get_varint(p, end, version);
+                block_.value_versions[i] = version;
+                size_t offset = block_.values.size();
+                block_.values.resize(offset + raw);
+                deriver_.fill(key, version, &block_.values[offset], raw);
+            } else {
+                if (static_cast<uint64_t>(end - p) < raw) {
+                    throw runtime_error(
+                        "Truncated value in binary trace block");
+                }
+                block_.values.append(p, raw);
+                p += raw;
+            }
+        }
+    }
+    block_.count = count;
+    position_ = 0;
+}
+
+RequestGenerator::Phase BinaryTraceReader::next(loadgen::types::Type &type,
+                                                long &key, std::string &value,
+                                                long &scan_size) {
+    value.clear();
+    scan_size = 0;
+
+    if (position_ == block_.count) {
+        if (next_block_ >= index_.size()) {
+            return RequestGenerator::Phase::DONE;
+        }
+        load_block(next_block_++);
+    }
+
+    type = block_.types[position_];
+    key = block_.keys[position_];
+    phase_index_ = block_.phase_indices[position_];
+    arrival_ns_ = block_.arrival_times[position_];
+    scan_size = block_.scan_sizes[position_];
+    if (type == loadgen::types::Type::MULTI_GET) {
+        const long *keys =
+            block_.multi_get_keys.data() + block_.key_offsets[position_];
+        multi_get_keys_.assign(keys, keys + scan_size);
+    }
+    value.assign(block_.values, block_.value_offsets[position_],
+                 block_.value_lengths[position_]);
+    return block_.phases[position_++];
+}
+
+size_t BinaryTraceReader::next_batch(size_t n,
+                                     RequestGenerator::RequestBatch &batch) {
+    batch.resize(n);
+
+    size_t count = 0;
+    while (count < n) {
+        if (position_ == block_.count) {
+            if (next_block_ >= index_.size()) {
+                break;
+            }
+            load_block(next_block_++);
+        }
+        size_t take = min(n - count, block_.count - position_);
+        copy_n(block_.phases.begin() + position_, take,
+               batch.phases.begin() + count);
+        copy_n(block_.phase_indices.begin() + position_, take,
+               batch.phase_indices.begin() + count);
+        copy_n(block_.arrival_times.begin() + position_, take,
+               batch.arrival_times.begin() + count);
+        copy_n(block_.types.begin() + position_, take,
+               batch.types.begin() + count);
+        copy_n(block_.keys.begin() + position_, take,
+               batch.keys.begin() + count);
+        copy_n(block_.scan_sizes.begin() + position_, take,
+               batch.scan_sizes.begin() + count);
+        for (size_t i = 0; i < take; i++) {
+            batch.value_offsets[count + i] = batch.values.size();
+            batch.value_lengths[count + i] =
+                block_.value_lengths[position_ + i];
+            batch.value_versions[count + i] =
+                block_.value_versions[position_ + i];
+            batch.values.append(block_.values,
+                                block_.value_offsets[position_ + i],
+                                block_.value_lengths[position_ + i]);
+            batch.key_offsets[count + i] = batch.multi_get_keys.size();
+            if (block_.types[position_ + i] ==
+                loadgen::types::Type::MULTI_GET) {
+                const long *keys = block_.multi_get_keys.data() +
+                                   block_.key_offsets[position_ + i];
+                batch.multi_get_keys.insert(
+                    batch.multi_get_keys.end(), keys,
+                    keys + block_.scan_sizes[position_ + i]);
+            }
+        }
+        position_ += take;
+        count += take;
+    }
+
+    batch.count = count;
+    return count;
+}
+
+} // namespace workload
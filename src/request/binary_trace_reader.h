@@ -0,0 +1,101 @@
+#ifndef WORKLOAD_BINARY_TRACE_READER_H
+#define WORKLOAD_BINARY_TRACE_READER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "request_generator.h"
+#include "value_deriver.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// Start of an operation phase in a binary trace.
+struct TracePhase {
+    /// Index in Configuration::phases of the workload.
+    size_t index;
+    std::string name;
+    /// Index of the first request of the phase.
+    uint64_t first;
+};
+
+/// Reader of traces exported with `output.requests.format = "BINARY"`.
+///
+/// Requests are decoded one block at a time into the representation
+/// RequestGenerator::next() produces; DERIVED values are regenerated from
+/// their length and version. The block index at the end of the file makes
+/// seek() cost one block decode.
+class BinaryTraceReader {
+public:
+    /// Open the trace and load its header and block index.
+    explicit BinaryTraceReader(const std::string &path);
+
+    /// Configuration the trace was generated with.
+    const RequestGenerator::Configuration &config() const;
+
+    /// Number of requests in the trace.
+    uint64_t size() const;
+
+    /// Number of blocks in the trace.
+    uint64_t block_count() const;
+
+    /// Phases of the trace, in order; empty for workloads without phases.
+    const std::vector<TracePhase> &phases() const { return phases_; }
+
+    /// Same as RequestGenerator::phase_index() for the last request returned
+    /// by next().
+    size_t phase_index() const { return phase_index_; }
+
+    /// Same as RequestGenerator::arrival_ns() for the last request returned
+    /// by next().
+    uint64_t arrival_ns() const { return arrival_ns_; }
+
+    /// Position the reader on request `index` (size() moves to the end).
+    void seek(uint64_t index);
+
+    /// Get the next request, same contract as RequestGenerator::next().
+    /// @return The phase of the request, or DONE at the end of the trace.
+    RequestGenerator::Phase next(loadgen::types::Type &type, long &key,
+                                 std::string &value, long &scan_size);
+
+    /// Keys of the MULTI_GET last returned by next(), valid until the next
+    /// call.
+    const std::vector<long> &multi_get_keys() const { return multi_get_keys_; }
+
+    /// Fill `batch` with up to `n` requests.
+    /// @return Number of requests in the batch (0 at the end of the trace).
+    size_t next_batch(size_t n, RequestGenerator::RequestBatch &batch);
+
+private:
+    struct BlockIndexEntry {
+        uint64_t offset;
+        uint64_t first;
+        uint32_t count;
+    };
+
+    /// Decode block `block` into block_.
+    void load_block(size_t block);
+
+    std::ifstream in_;
+    RequestGenerator::Configuration config_;
+    std::vector<BlockIndexEntry> index_;
+    std::vector<TracePhase> phases_;
+    uint64_t size_ = 0;
+
+    size_t next_block_ = 0;
+    RequestGenerator::RequestBatch block_;
+    size_t position_ = 0;
+    std::vector<long> multi_get_keys_;
+    size_t phase_index_ = 0;
+    uint64_t arrival_ns_ = 0;
+    std::string payload_;
+    bool derived_values_ = false;
+    bool timed_ = false;
+    ValueDeriver deriver_;
+};
+
+} // namespace workload
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef WORKLOAD_BYTE_VIEW_H
+#define WORKLOAD_BYTE_VIEW_H
+
+#include <cstddef>
+#include <string>
+
+namespace workload {
+
+/// Non-owning view of a byte range; the owner of the bytes decides how long
+/// it stays valid.
+struct ByteView {
+    const char *data = nullptr;
+    size_t size = 0;
+
+    ByteView() {}
+    ByteView(const char *data_, size_t size_) : data(data_), size(size_) {}
+
+    std::string str() const { return std::string(data, size); }
+};
+
+} // namespace workload
+
+#endif
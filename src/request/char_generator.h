@@ -16,6 +16,19 @@ public:
     }
     inline char operator()() { return __CHARSET[__generator()]; }
 
+    /// Draw a character from a caller-supplied engine.
+    template <typename _UniformRandomBitGenerator>
+    static char draw(_UniformRandomBitGenerator &__urng) {
+        std::uniform_int_distribution<long> distribution(0, __CHARSET_LEN - 1);
+        return __CHARSET[distribution(__urng)];
+    }
+
+    /// Character for a uniformly distributed byte (the mapping is slightly
+    /// biased towards the start of the charset).
+    static char from_byte(unsigned char byte) {
+        return __CHARSET[(byte * __CHARSET_LEN) >> 8];
+    }
+
 private:
     static const char __CHARSET[];
     static const size_t __CHARSET_LEN;
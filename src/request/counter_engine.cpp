@@ -0,0 +1 @@
+#include "counter_engine.h"
\ No newline at end of file
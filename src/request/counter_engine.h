@@ -0,0 +1,50 @@
+#ifndef RFUNC_COUNTER_ENGINE_H
+#define RFUNC_COUNTER_ENGINE_H
+
+#include <cstdint>
+
+namespace rfunc {
+
+/// Counter-based random bit generator.
+///
+/// The engine state is derived from a (seed, stream) pair instead of from
+/// the previous draw of a shared engine, so the randomness of request `i` can
+/// be reconstructed without generating requests `0 … i-1` first. Each stream
+/// is a splitmix64 sequence, which is cheap to seed and good enough for
+/// workload generation.
+class counter_engine {
+public:
+    typedef uint64_t result_type;
+
+    counter_engine(uint64_t seed = 0, uint64_t stream = 0) {
+        this->seed(seed, stream);
+    }
+
+    void seed(uint64_t seed, uint64_t stream = 0) {
+        state_ = mix(mix(seed) ^ (stream * STREAM_MULTIPLIER));
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        state_ += GOLDEN_GAMMA;
+        return mix(state_);
+    }
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    static const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+    static const uint64_t STREAM_MULTIPLIER = 0xD1342543DE82EF95ULL;
+
+    uint64_t state_;
+};
+
+} // namespace rfunc
+
+#endif
@@ -0,0 +1,245 @@
+#include "csv_trace_reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace workload {
+using namespace std;
+
+// ────────────────────────────────────────────────────────────────────────
+// Line parsing
+// ────────────────────────────────────────────────────────────────────────
+// Keys and scan sizes are read with a plain digit loop; the only unbounded
+// scan is the one for the end of a WRITE value, which goes through memchr()
+// (vectorized by the C library).
+
+static const char *parse_long(const char *p, const char *end, long &value) {
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        p++;
+    }
+    const char *digits = p;
+    unsigned long magnitude = 0;
+    while (p < end && static_cast<unsigned char>(*p - '0') < 10) {
+        magnitude = magnitude * 10 + static_cast<unsigned long>(*p - '0');
+        p++;
+    }
+    if (p == digits) {
+        throw runtime_error("Malformed CSV trace line: expected a number");
+    }
+    value = negative ? -static_cast<long>(magnitude)
+                     : static_cast<long>(magnitude);
+    return p;
+}
+
+// Key field: its bytes, and the number it starts with (-1 when it starts with
+// a letter, as `user<hash>` keys do).
+static const char *parse_key(const char *p, const char *end, long &key,
+                             ByteView &encoded) {
+    const char *field = p;
+    if (p < end && (static_cast<unsigned char>(*p - '0') < 10 || *p == '-')) {
+        p = parse_long(p, end, key);
+    } else {
+        key = -1;
+    }
+    while (p < end && *p != ',' && *p != '\n') {
+        p++;
+    }
+    encoded = ByteView(field, static_cast<size_t>(p - field));
+    return p;
+}
+
+static const char PHASE_MARKER[] = "#phase,";
+static const size_t PHASE_MARKER_SIZE = sizeof(PHASE_MARKER) - 1;
+
+bool CsvTraceRange::next(TraceRecord &record) {
+    const char *p = pos_;
+    // Phase markers: `#phase,index,name`.
+    while (p < end_ && *p == '#') {
+        if (static_cast<size_t>(end_ - p) < PHASE_MARKER_SIZE ||
+            memcmp(p, PHASE_MARKER, PHASE_MARKER_SIZE) != 0) {
+            throw runtime_error("Malformed CSV trace line: bad marker");
+        }
+        long index;
+        p = parse_long(p + PHASE_MARKER_SIZE, end_, index);
+        phase_ = static_cast<size_t>(index);
+        const char *eol = static_cast<const char *>(
+            memchr(p, '\n', static_cast<size_t>(end_ - p)));
+        p = eol != nullptr ? eol + 1 : end_;
+    }
+    if (p >= end_) {
+        pos_ = p;
+        return false;
+    }
+    record.phase_index = phase_;
+    record.arrival_ns = 0;
+    if (*p == '@') {
+        long arrival;
+        p = parse_long(p + 1, end_, arrival);
+        if (p == end_ || *p != ',') {
+            throw runtime_error("Malformed CSV trace line: bad arrival time");
+        }
+        record.arrival_ns = static_cast<uint64_t>(arrival);
+        p++;
+    }
+
+    long type;
+    p = parse_long(p, end_, type);
+    if (type < static_cast<long>(loadgen::types::Type::READ) ||
+        type > static_cast<long>(loadgen::types::Type::MULTI_GET) ||
+        p == end_ || *p != ',') {
+        throw runtime_error("Malformed CSV trace line: bad operation type");
+    }
+    record.type = static_cast<loadgen::types::Type>(type);
+    p = parse_key(p + 1, end_, record.key, record.encoded_key);
+    record.scan_size = 0;
+    record.value = ByteView();
+    record.derived = false;
+
+    if (record.type == loadgen::types::Type::MULTI_GET) {
+        record.keys.clear();
+        record.keys.push_back(record.key);
+        record.encoded_keys.clear();
+        record.encoded_keys.push_back(record.encoded_key);
+        long key;
+        ByteView encoded;
+        while (p < end_ && *p == ',') {
+            p = parse_key(p + 1, end_, key, encoded);
+            record.keys.push_back(key);
+            record.encoded_keys.push_back(encoded);
+        }
+        record.scan_size = static_cast<long>(record.keys.size());
+    } else if (p < end_ && *p == ',') {
+        p++;
+        if (record.type == loadgen::types::Type::SCAN) {
+            p = parse_long(p, end_, record.scan_size);
+        } else if (p < end_ && *p == '#') {
+            long length, version;
+            p = parse_long(p + 1, end_, length);
+            if (p == end_ || *p != ',') {
+                throw runtime_error(
+                    "Malformed CSV trace line: bad derived value");
+            }
+            p = parse_long(p + 1, end_, version);
+            record.derived = true;
+            record.derived_length = static_cast<size_t>(length);
+            record.derived_version = static_cast<uint64_t>(version);
+        } else {
+            const char *eol = static_cast<const char *>(
+                memchr(p, '\n', static_cast<size_t>(end_ - p)));
+            if (eol == nullptr) {
+                eol = end_;
+            }
+            record.value.data = p;
+            record.value.size = static_cast<size_t>(eol - p);
+            p = eol;
+        }
+    }
+
+    if (p < end_) {
+        if (*p != '\n') {
+            throw runtime_error("Malformed CSV trace line: trailing data");
+        }
+        p++;
+    }
+    pos_ = p;
+    return true;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// CsvTraceReader
+// ────────────────────────────────────────────────────────────────────────
+CsvTraceReader::CsvTraceReader(const std::string &path) :
+    data_(nullptr), size_(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Cannot open CSV trace " + path + ": " +
+                            strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw runtime_error("Cannot stat CSV trace " + path + ": " +
+                            strerror(error));
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    if (size_ > 0) {
+        void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw runtime_error("Cannot map CSV trace " + path + ": " +
+                                strerror(error));
+        }
+        madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(data);
+    }
+    // The mapping keeps the file referenced.
+    ::close(fd);
+}
+
+CsvTraceReader::~CsvTraceReader() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+}
+
+std::vector<CsvTraceRange> CsvTraceReader::split(size_t n) const {
+    if (n == 0) {
+        n = 1;
+    }
+    vector<CsvTraceRange> ranges;
+    ranges.reserve(n);
+
+    // Phase markers are rare, and '#phase,' cannot appear inside a line
+    // ('#' is not in the value charset), so one search finds them all.
+    vector<pair<const char *, size_t>> markers;
+    for (const char *p = data_; size_ > 0;) {
+        const void *found =
+            memmem(p, static_cast<size_t>(data_ + size_ - p), PHASE_MARKER,
+                   PHASE_MARKER_SIZE);
+        if (found == nullptr) {
+            break;
+        }
+        p = static_cast<const char *>(found);
+        long index;
+        p = parse_long(p + PHASE_MARKER_SIZE, data_ + size_, index);
+        markers.push_back(make_pair(p, static_cast<size_t>(index)));
+    }
+
+    // Each cut moves forward to the start of the next line.
+    const char *begin = data_;
+    size_t marker = 0, phase = 0;
+    for (size_t i = 1; i <= n; i++) {
+        const char *end = data_ + size_;
+        if (i < n) {
+            const char *cut = data_ + size_ / n * i + size_ % n * i / n;
+            if (cut < begin) {
+                cut = begin;
+            }
+            if (cut > data_ && cut[-1] != '\n') {
+                const char *eol = static_cast<const char *>(
+                    memchr(cut, '\n', static_cast<size_t>(end - cut)));
+                cut = eol != nullptr ? eol + 1 : end;
+            }
+            end = cut;
+        }
+        ranges.push_back(CsvTraceRange(begin, end, phase));
+        while (marker < markers.size() && markers[marker].first < end) {
+            phase = markers[marker++].second;
+        }
+        begin = end;
+    }
+    return ranges;
+}
+
+} // namespace workload
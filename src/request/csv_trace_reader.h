@@ -0,0 +1,155 @@
+#ifndef WORKLOAD_CSV_TRACE_READER_H
+#define WORKLOAD_CSV_TRACE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "byte_view.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// One line of a CSV trace. `value` points into the mapping and is empty for
+/// the types without a value and for writes exported without values.
+///
+/// MULTI_GETs fill `keys`, `key` first, and set `scan_size` to their count.
+/// The vector is reused from one record to the next, so parsing only
+/// allocates when a MULTI_GET is larger than all the ones before it.
+///
+/// DERIVED values are not in the trace: `derived` is set and
+/// `derived_length`/`derived_version` give the value to regenerate with
+/// ValueDeriver.
+///
+/// `phase_index` is the index of the last `#phase` marker line before the
+/// record (0 before the first one); marker lines are not records.
+/// `arrival_ns` is the intended issue time of an `@arrival_ns,` line (0 for
+/// lines without one).
+///
+/// CSV traces hold the keys in their key_encoding: `encoded_key` and, for
+/// MULTI_GETs, `encoded_keys` point at their bytes in the mapping. `key` and
+/// `keys` are the numbers the key fields start with (the key itself for
+/// DECIMAL and VARIABLE keys), or -1 for fields that start with a letter.
+/// Binary traces store the numeric keys, with the encoding in their header
+/// (see KeyEncoder), and leave the encoded keys empty.
+struct TraceRecord {
+    loadgen::types::Type type = loadgen::types::Type::READ;
+    long key = 0;
+    long scan_size = 0;
+    std::vector<long> keys;
+    ByteView encoded_key;
+    std::vector<ByteView> encoded_keys;
+    ByteView value;
+    bool derived = false;
+    size_t derived_length = 0;
+    uint64_t derived_version = 0;
+    size_t phase_index = 0;
+    uint64_t arrival_ns = 0;
+};
+
+/// Line-aligned byte range of a CSV trace, parsed without allocating.
+class CsvTraceRange {
+public:
+    class iterator {
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef TraceRecord value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const TraceRecord *pointer;
+        typedef const TraceRecord &reference;
+
+        iterator() : range_(nullptr) {}
+        explicit iterator(CsvTraceRange *range) : range_(range) { ++*this; }
+
+        const TraceRecord &operator*() const { return record_; }
+        const TraceRecord *operator->() const { return &record_; }
+
+        iterator &operator++() {
+            if (!range_->next(record_)) {
+                range_ = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const {
+            return range_ == other.range_;
+        }
+        bool operator!=(const iterator &other) const {
+            return range_ != other.range_;
+        }
+
+    private:
+        CsvTraceRange *range_;
+        TraceRecord record_;
+    };
+
+    CsvTraceRange() :
+        begin_(nullptr), pos_(nullptr), end_(nullptr), first_phase_(0),
+        phase_(0) {}
+    /// @param[in] phase_index  Phase of the records before the first marker
+    /// of the range.
+    CsvTraceRange(const char *begin, const char *end,
+                  size_t phase_index = 0) :
+        begin_(begin), pos_(begin), end_(end), first_phase_(phase_index),
+        phase_(phase_index) {}
+
+    /// Parse the next line into `record`.
+    /// @return false at the end of the range.
+    bool next(TraceRecord &record);
+
+    /// Restart from the first line of the range.
+    void rewind() {
+        pos_ = begin_;
+        phase_ = first_phase_;
+    }
+
+    /// Size of the range in bytes.
+    size_t size() const { return static_cast<size_t>(end_ - begin_); }
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+private:
+    const char *begin_;
+    const char *pos_;
+    const char *end_;
+    size_t first_phase_;
+    size_t phase_;
+};
+
+/// Memory-mapped reader of traces exported with `output.requests.format =
+/// "CSV"`.
+///
+/// The file stays mapped for the lifetime of the reader; ranges and the
+/// values of the records they return must not outlive it.
+class CsvTraceReader {
+public:
+    /// Map the trace at `path`.
+    explicit CsvTraceReader(const std::string &path);
+    ~CsvTraceReader();
+
+    CsvTraceReader(const CsvTraceReader &) = delete;
+    CsvTraceReader &operator=(const CsvTraceReader &) = delete;
+
+    /// Size of the trace in bytes.
+    size_t size() const { return size_; }
+
+    /// The whole trace.
+    CsvTraceRange range() const { return CsvTraceRange(data_, data_ + size_); }
+
+    /// Split the trace into `n` consecutive ranges of about the same size,
+    /// each starting at the beginning of a line and knowing the phase it
+    /// starts in. Ranges may be empty when the trace has fewer lines than
+    /// `n`.
+    std::vector<CsvTraceRange> split(size_t n) const;
+
+private:
+    const char *data_;
+    size_t size_;
+};
+
+} // namespace workload
+
+#endif
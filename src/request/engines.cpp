@@ -0,0 +1 @@
+#include "engines.h"
\ No newline at end of file
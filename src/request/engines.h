@@ -0,0 +1,130 @@
+#ifndef RFUNC_ENGINES_H
+#define RFUNC_ENGINES_H
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+#include "counter_engine.h"
+
+namespace rfunc {
+
+/// xoshiro256** 1.0 (Blackman & Vigna). Seeded by expanding the seed through
+/// splitmix64, as recommended by the authors.
+class xoshiro256ss {
+public:
+    typedef uint64_t result_type;
+
+    static const result_type default_seed = 5489u;
+
+    explicit xoshiro256ss(result_type seed = default_seed) {
+        this->seed(seed);
+    }
+
+    void seed(result_type seed) {
+        counter_engine expander(seed);
+        for (int i = 0; i < 4; i++) {
+            s_[i] = expander();
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+
+        return result;
+    }
+
+    /// Text state, like the std engines.
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const xoshiro256ss &engine) {
+        return os << engine.s_[0] << ' ' << engine.s_[1] << ' '
+                  << engine.s_[2] << ' ' << engine.s_[3];
+    }
+
+    friend std::istream &operator>>(std::istream &is, xoshiro256ss &engine) {
+        return is >> engine.s_[0] >> engine.s_[1] >> engine.s_[2] >>
+               engine.s_[3];
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s_[4];
+};
+
+__extension__ typedef unsigned __int128 pcg128_t;
+
+/// PCG64 (PCG-XSL-RR 128/64, O'Neill) with the default stream.
+class pcg64 {
+public:
+    typedef uint64_t result_type;
+
+    static const result_type default_seed = 5489u;
+
+    explicit pcg64(result_type seed = default_seed) { this->seed(seed); }
+
+    void seed(result_type seed) {
+        state_ = 0;
+        step();
+        state_ += seed;
+        step();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        step();
+        uint64_t xored =
+            static_cast<uint64_t>(state_ >> 64) ^ static_cast<uint64_t>(state_);
+        unsigned rot = static_cast<unsigned>(state_ >> 122);
+        return (xored >> rot) | (xored << ((64 - rot) & 63));
+    }
+
+    /// Text state (high and low halves), like the std engines.
+    friend std::ostream &operator<<(std::ostream &os, const pcg64 &engine) {
+        return os << static_cast<uint64_t>(engine.state_ >> 64) << ' '
+                  << static_cast<uint64_t>(engine.state_);
+    }
+
+    friend std::istream &operator>>(std::istream &is, pcg64 &engine) {
+        uint64_t high, low;
+        if (is >> high >> low) {
+            engine.state_ = (static_cast<pcg128_t>(high) << 64) | low;
+        }
+        return is;
+    }
+
+private:
+    void step() { state_ = state_ * multiplier() + increment(); }
+
+    static pcg128_t multiplier() {
+        return (static_cast<pcg128_t>(0x2360ED051FC65DA4ULL) << 64) |
+               0x4385DF649FCCF645ULL;
+    }
+
+    static pcg128_t increment() {
+        return (static_cast<pcg128_t>(0x5851F42D4C957F2DULL) << 64) |
+               0x14057B7EF767814FULL;
+    }
+
+    pcg128_t state_;
+};
+
+} // namespace rfunc
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef RFUNC_FEISTEL_PERMUTATION_H
+#define RFUNC_FEISTEL_PERMUTATION_H
+
+#include <cstdint>
+#include <utility>
+
+#include "counter_engine.h"
+
+namespace rfunc {
+
+/// Seedable bijection of [0, size) onto itself.
+///
+/// A Feistel network permutes the integers of the smallest bit width n that
+/// covers [0, size), split into halves of n / 2 and n - n / 2 bits that swap
+/// places every round. Values it maps at or past `size` are encrypted again
+/// (cycle walking) until they fall inside, so the map stays a bijection of
+/// [0, size). That range is less than twice `size`, so a value takes fewer
+/// than two passes on average, each of ROUNDS splitmix64 finalizers. The
+/// state is the size and the round keys.
+class feistel_permutation {
+public:
+    static const int ROUNDS = 4;
+
+    explicit feistel_permutation(uint64_t size = 1, uint64_t seed = 0) :
+        size_(size > 0 ? size : 1) {
+        int bits = 2;
+        while (bits < 64 && (uint64_t(1) << bits) < size_) {
+            bits++;
+        }
+        left_bits_ = bits / 2;
+        right_bits_ = bits - left_bits_;
+        counter_engine keys(seed);
+        for (int i = 0; i < ROUNDS; i++) {
+            keys_[i] = keys();
+        }
+    }
+
+    uint64_t size() const { return size_; }
+
+    /// Image of `value` < size().
+    uint64_t operator()(uint64_t value) const {
+        do {
+            value = encrypt(value);
+        } while (value >= size_);
+        return value;
+    }
+
+    /// Value < size() whose image is `image`.
+    uint64_t inverse(uint64_t image) const {
+        do {
+            image = decrypt(image);
+        } while (image >= size_);
+        return image;
+    }
+
+private:
+    /// Round function, `bits` wide.
+    uint64_t round(uint64_t half, int i, int bits) const {
+        return counter_engine::mix(half ^ keys_[i]) & mask(bits);
+    }
+
+    static uint64_t mask(int bits) { return (uint64_t(1) << bits) - 1; }
+
+    // Each round maps (left, right) to (right, left ^ round(right)); the
+    // widths swap with the halves and are back in place after an even
+    // number of rounds.
+    uint64_t encrypt(uint64_t value) const {
+        int left_bits = left_bits_, right_bits = right_bits_;
+        uint64_t left = value >> right_bits, right = value & mask(right_bits);
+        for (int i = 0; i < ROUNDS; i++) {
+            uint64_t next = left ^ round(right, i, left_bits);
+            left = right;
+            right = next;
+            std::swap(left_bits, right_bits);
+        }
+        return (left << right_bits) | right;
+    }
+
+    uint64_t decrypt(uint64_t value) const {
+        int left_bits = left_bits_, right_bits = right_bits_;
+        uint64_t left = value >> right_bits, right = value & mask(right_bits);
+        for (int i = ROUNDS - 1; i >= 0; i--) {
+            uint64_t previous = right ^ round(left, i, right_bits);
+            right = left;
+            left = previous;
+            std::swap(left_bits, right_bits);
+        }
+        return (left << right_bits) | right;
+    }
+
+    uint64_t size_;
+    int left_bits_;
+    int right_bits_;
+    uint64_t keys_[ROUNDS];
+};
+
+} // namespace rfunc
+
+#endif
@@ -0,0 +1,306 @@
+#include "generator_metrics.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+static int64_t now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+               chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// GeneratorCounters
+// ────────────────────────────────────────────────────────────────────────
+GeneratorCounters::GeneratorCounters() : phase_(-1), phase_start_ns_(0) {
+    for (int i = 0; i < COUNTERS; i++) {
+        values_[i].store(0, memory_order_relaxed);
+    }
+    phase_ns_[0].store(0, memory_order_relaxed);
+    phase_ns_[1].store(0, memory_order_relaxed);
+}
+
+void GeneratorCounters::switch_phase(int phase) {
+    int64_t now = now_ns();
+    int previous = phase_.load(memory_order_relaxed);
+    if (previous == 0 || previous == 1) {
+        phase_ns_[previous].store(
+            phase_ns_[previous].load(memory_order_relaxed) + now -
+                phase_start_ns_.load(memory_order_relaxed),
+            memory_order_relaxed);
+    }
+    phase_start_ns_.store(now, memory_order_relaxed);
+    phase_.store(phase, memory_order_release);
+}
+
+double GeneratorCounters::phase_seconds(RequestGenerator::Phase phase) const {
+    int index = static_cast<int>(phase);
+    if (index != 0 && index != 1) {
+        return 0;
+    }
+    int64_t ns = phase_ns_[index].load(memory_order_relaxed);
+    if (phase_.load(memory_order_acquire) == index) {
+        ns += now_ns() - phase_start_ns_.load(memory_order_relaxed);
+    }
+    return ns / 1e9;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// GeneratorMetrics
+// ────────────────────────────────────────────────────────────────────────
+GeneratorMetrics::GeneratorMetrics() :
+    start_(chrono::steady_clock::now()), output_bytes_(0) {}
+
+GeneratorCounters *GeneratorMetrics::add_shard() {
+    lock_guard<mutex> lock(mutex_);
+    shards_.push_back(unique_ptr<GeneratorCounters>(new GeneratorCounters()));
+    return shards_.back().get();
+}
+
+MetricsSnapshot GeneratorMetrics::snapshot() const {
+    MetricsSnapshot snapshot;
+    snapshot.elapsed_seconds =
+        chrono::duration<double>(chrono::steady_clock::now() - start_)
+            .count();
+
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (size_t i = 0; i < shards_.size(); i++) {
+            const GeneratorCounters &shard = *shards_[i];
+            for (int c = 0; c < GeneratorCounters::COUNTERS; c++) {
+                snapshot.counters[c] +=
+                    shard.get(static_cast<GeneratorCounters::Counter>(c));
+            }
+            for (int p = 0; p < 2; p++) {
+                double seconds = shard.phase_seconds(
+                    static_cast<RequestGenerator::Phase>(p));
+                if (seconds > snapshot.phase_seconds[p]) {
+                    snapshot.phase_seconds[p] = seconds;
+                }
+            }
+        }
+    }
+
+    snapshot.output_bytes = output_bytes_.load(memory_order_relaxed);
+    if (snapshot.elapsed_seconds > 0) {
+        snapshot.output_bytes_per_second =
+            snapshot.output_bytes / snapshot.elapsed_seconds;
+    }
+    return snapshot;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Snapshot formats
+// ────────────────────────────────────────────────────────────────────────
+// Counters LOADED to MULTI_GETS, and READ_RETRIES to MULTI_GET_RETRIES.
+static const int OPERATIONS = 8;
+static const char *OPERATION_NAMES[] = {
+    "load", "read", "update", "insert", "scan", "delete", "read_modify_write",
+    "multi_get"};
+static const int RETRIES = 6;
+static const char *RETRY_NAMES[] = {"read",   "update", "scan",
+                                    "delete", "read_modify_write",
+                                    "multi_get"};
+static const char *PHASE_NAMES[] = {"loading", "operations"};
+
+static string format_number(double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.6f", value);
+    return buffer;
+}
+
+std::string MetricsSnapshot::to_json() const {
+    string json = "{\"elapsed_seconds\":" + format_number(elapsed_seconds);
+
+    json += ",\"requests\":{";
+    for (int i = 0; i < OPERATIONS; i++) {
+        json += string(i > 0 ? "," : "") + "\"" + OPERATION_NAMES[i] +
+                "\":" + to_string(counters[GeneratorCounters::LOADED + i]);
+    }
+    json += "},\"key_retries\":{";
+    for (int i = 0; i < RETRIES; i++) {
+        json += string(i > 0 ? "," : "") + "\"" + RETRY_NAMES[i] + "\":" +
+                to_string(counters[GeneratorCounters::READ_RETRIES + i]);
+    }
+    json += "},\"phase_seconds\":{";
+    for (int p = 0; p < 2; p++) {
+        json += string(p > 0 ? "," : "") + "\"" + PHASE_NAMES[p] +
+                "\":" + format_number(phase_seconds[p]);
+    }
+    json += "},\"clamped_keys\":" +
+            to_string(counters[GeneratorCounters::CLAMPED_KEYS]);
+    json += ",\"scanned_keys\":" +
+            to_string(counters[GeneratorCounters::SCANNED_KEYS]);
+    json += ",\"multi_get_keys\":" +
+            to_string(counters[GeneratorCounters::MULTI_GET_KEYS]);
+    json += ",\"value_bytes\":" +
+            to_string(counters[GeneratorCounters::VALUE_BYTES]);
+    json += ",\"output_bytes\":" + to_string(output_bytes);
+    json += ",\"output_bytes_per_second\":" +
+            format_number(output_bytes_per_second) + "}";
+    return json;
+}
+
+std::string MetricsSnapshot::to_prometheus() const {
+    string text;
+    text += "# HELP loadgen_requests_total Requests generated.\n"
+            "# TYPE loadgen_requests_total counter\n";
+    for (int i = 0; i < OPERATIONS; i++) {
+        text += string("loadgen_requests_total{operation=\"") +
+                OPERATION_NAMES[i] + "\"} " +
+                to_string(counters[GeneratorCounters::LOADED + i]) + "\n";
+    }
+    text += "# HELP loadgen_key_retries_total Key draws rejected by the "
+            "read bounds.\n"
+            "# TYPE loadgen_key_retries_total counter\n";
+    for (int i = 0; i < RETRIES; i++) {
+        text += string("loadgen_key_retries_total{operation=\"") +
+                RETRY_NAMES[i] + "\"} " +
+                to_string(counters[GeneratorCounters::READ_RETRIES + i]) +
+                "\n";
+    }
+    text += "# HELP loadgen_clamped_keys_total Bounded key draws with no "
+            "key below the bound.\n"
+            "# TYPE loadgen_clamped_keys_total counter\n"
+            "loadgen_clamped_keys_total " +
+            to_string(counters[GeneratorCounters::CLAMPED_KEYS]) + "\n";
+    text += "# HELP loadgen_scanned_keys_total Keys covered by scans.\n"
+            "# TYPE loadgen_scanned_keys_total counter\n"
+            "loadgen_scanned_keys_total " +
+            to_string(counters[GeneratorCounters::SCANNED_KEYS]) + "\n";
+    text += "# HELP loadgen_multi_get_keys_total Keys read by multi-gets.\n"
+            "# TYPE loadgen_multi_get_keys_total counter\n"
+            "loadgen_multi_get_keys_total " +
+            to_string(counters[GeneratorCounters::MULTI_GET_KEYS]) + "\n";
+    text += "# HELP loadgen_value_bytes_total Value bytes generated.\n"
+            "# TYPE loadgen_value_bytes_total counter\n"
+            "loadgen_value_bytes_total " +
+            to_string(counters[GeneratorCounters::VALUE_BYTES]) + "\n";
+    text += "# HELP loadgen_output_bytes_total Trace bytes written.\n"
+            "# TYPE loadgen_output_bytes_total counter\n"
+            "loadgen_output_bytes_total " +
+            to_string(output_bytes) + "\n";
+    text += "# HELP loadgen_output_bytes_per_second Trace bytes written per "
+            "second since the start.\n"
+            "# TYPE loadgen_output_bytes_per_second gauge\n"
+            "loadgen_output_bytes_per_second " +
+            format_number(output_bytes_per_second) + "\n";
+    text += "# HELP loadgen_phase_seconds Time spent in each phase.\n"
+            "# TYPE loadgen_phase_seconds gauge\n";
+    for (int p = 0; p < 2; p++) {
+        text += string("loadgen_phase_seconds{phase=\"") + PHASE_NAMES[p] +
+                "\"} " + format_number(phase_seconds[p]) + "\n";
+    }
+    text += "# HELP loadgen_elapsed_seconds Time since the start.\n"
+            "# TYPE loadgen_elapsed_seconds gauge\n"
+            "loadgen_elapsed_seconds " +
+            format_number(elapsed_seconds) + "\n";
+    return text;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// MetricsReporter
+// ────────────────────────────────────────────────────────────────────────
+MetricsReporter::MetricsReporter(const GeneratorMetrics &metrics,
+                                 const std::string &path, Format format,
+                                 long interval_ms) :
+    metrics_(metrics), path_(path), format_(format),
+    interval_(interval_ms > 0 ? interval_ms : 1000) {
+    if (format_ == Format::JSON && path_ != "-") {
+        file_.reset(new ofstream(path_, ios::trunc));
+        if (!*file_) {
+            throw runtime_error("Cannot open metrics file " + path_);
+        }
+    }
+    report();
+    thread_ = thread(&MetricsReporter::loop, this);
+}
+
+MetricsReporter::~MetricsReporter() {
+    try {
+        stop();
+    } catch (...) {
+    }
+}
+
+void MetricsReporter::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    report();
+}
+
+void MetricsReporter::loop() {
+    unique_lock<mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval_, [this]() { return stop_; })) {
+        lock.unlock();
+        try {
+            report();
+        } catch (...) {
+            // A failed periodic write is retried at the next interval; the
+            // final one in stop() reports errors.
+        }
+        lock.lock();
+    }
+}
+
+void MetricsReporter::report() {
+    MetricsSnapshot snapshot = metrics_.snapshot();
+
+    if (format_ == Format::JSON) {
+        ostream &os = file_ ? *file_ : cerr;
+        os << snapshot.to_json() << endl;
+        if (!os) {
+            throw runtime_error("Cannot write metrics file " + path_);
+        }
+        return;
+    }
+
+    if (path_ == "-") {
+        cerr << snapshot.to_prometheus() << endl;
+        return;
+    }
+    string temporary = path_ + ".tmp";
+    {
+        ofstream os(temporary, ios::trunc);
+        os << snapshot.to_prometheus();
+        if (!os.flush()) {
+            throw runtime_error("Cannot write metrics file " + temporary);
+        }
+    }
+    if (rename(temporary.c_str(), path_.c_str()) != 0) {
+        throw runtime_error("Cannot replace metrics file " + path_);
+    }
+}
+
+std::unique_ptr<MetricsReporter>
+make_metrics_reporter(const GeneratorMetrics &metrics,
+                      const RequestGenerator::Configuration &config) {
+    if (config.metrics_path.empty()) {
+        return unique_ptr<MetricsReporter>();
+    }
+    MetricsReporter::Format format;
+    if (config.metrics_format == "JSON") {
+        format = MetricsReporter::Format::JSON;
+    } else if (config.metrics_format == "PROMETHEUS") {
+        format = MetricsReporter::Format::PROMETHEUS;
+    } else {
+        throw invalid_argument("Unknown metrics format: " +
+                               config.metrics_format);
+    }
+    return unique_ptr<MetricsReporter>(new MetricsReporter(
+        metrics, config.metrics_path, format, config.metrics_interval_ms));
+}
+
+} // namespace workload
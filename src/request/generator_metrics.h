@@ -0,0 +1,229 @@
+#ifndef WORKLOAD_GENERATOR_METRICS_H
+#define WORKLOAD_GENERATOR_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "request_generator.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// Counters of the requests generated by one thread at a time.
+///
+/// Every pipeline, stream and export worker owns one shard and is its only
+/// writer, so updates are a relaxed load and store with no read-modify-write
+/// or shared cache line. Snapshots may be taken from any thread.
+class GeneratorCounters {
+public:
+    enum Counter {
+        /// Records of the loading phase.
+        LOADED,
+        READS,
+        UPDATES,
+        INSERTS,
+        SCANS,
+        DELETES,
+        READ_MODIFY_WRITES,
+        MULTI_GETS,
+        /// Keys covered by the scans.
+        SCANNED_KEYS,
+        /// Keys read by the MULTI_GETs.
+        MULTI_GET_KEYS,
+        /// Key draws rejected by the read bounds, per operation type.
+        READ_RETRIES,
+        UPDATE_RETRIES,
+        SCAN_RETRIES,
+        DELETE_RETRIES,
+        READ_MODIFY_WRITE_RETRIES,
+        MULTI_GET_RETRIES,
+        /// BOUNDED key draws, and draws among the live keys, with no key
+        /// below the bound, answered with key 0.
+        CLAMPED_KEYS,
+        /// Bytes of the values generated.
+        VALUE_BYTES,
+        COUNTERS
+    };
+
+    GeneratorCounters();
+
+    GeneratorCounters(const GeneratorCounters &) = delete;
+    GeneratorCounters &operator=(const GeneratorCounters &) = delete;
+
+    void add(Counter counter, uint64_t n) {
+        std::atomic<uint64_t> &value = values_[counter];
+        value.store(value.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+    }
+
+    /// Count one operation of `type` (UPDATE before it becomes a WRITE).
+    void add_operation(loadgen::types::Type type) {
+        switch (type) {
+        case loadgen::types::Type::READ:
+            add(READS, 1);
+            break;
+        case loadgen::types::Type::UPDATE:
+            add(UPDATES, 1);
+            break;
+        case loadgen::types::Type::WRITE:
+            add(INSERTS, 1);
+            break;
+        case loadgen::types::Type::SCAN:
+            add(SCANS, 1);
+            break;
+        case loadgen::types::Type::DEL:
+            add(DELETES, 1);
+            break;
+        case loadgen::types::Type::READ_MODIFY_WRITE:
+            add(READ_MODIFY_WRITES, 1);
+            break;
+        case loadgen::types::Type::MULTI_GET:
+            add(MULTI_GETS, 1);
+            break;
+        }
+    }
+
+    /// Counter of the key draws of `type` rejected by the read bounds
+    /// (READ_RETRIES for types that draw no key below them).
+    static Counter retries_of(loadgen::types::Type type) {
+        switch (type) {
+        case loadgen::types::Type::UPDATE:
+            return UPDATE_RETRIES;
+        case loadgen::types::Type::SCAN:
+            return SCAN_RETRIES;
+        case loadgen::types::Type::DEL:
+            return DELETE_RETRIES;
+        case loadgen::types::Type::READ_MODIFY_WRITE:
+            return READ_MODIFY_WRITE_RETRIES;
+        case loadgen::types::Type::MULTI_GET:
+            return MULTI_GET_RETRIES;
+        default:
+            return READ_RETRIES;
+        }
+    }
+
+    uint64_t get(Counter counter) const {
+        return values_[counter].load(std::memory_order_relaxed);
+    }
+
+    /// Start timing `phase`, ending the phase timed so far. Cheap when
+    /// `phase` is already the current one.
+    void enter_phase(RequestGenerator::Phase phase) {
+        int index = static_cast<int>(phase);
+        if (index != phase_.load(std::memory_order_relaxed)) {
+            switch_phase(index);
+        }
+    }
+
+    /// Seconds spent in `phase` so far, including the running one.
+    double phase_seconds(RequestGenerator::Phase phase) const;
+
+private:
+    void switch_phase(int phase);
+
+    std::atomic<uint64_t> values_[COUNTERS];
+    /// Phase being timed, -1 before the first request.
+    std::atomic<int> phase_;
+    std::atomic<int64_t> phase_start_ns_;
+    std::atomic<int64_t> phase_ns_[2];
+};
+
+/// Totals over every shard of a GeneratorMetrics.
+struct MetricsSnapshot {
+    /// Seconds since the metrics were created.
+    double elapsed_seconds = 0;
+    uint64_t counters[GeneratorCounters::COUNTERS] = {};
+    /// Wall time of the LOADING and OPERATIONS phases: the longest over the
+    /// shards, which run concurrently.
+    double phase_seconds[2] = {};
+    /// Trace bytes handed to the output file.
+    uint64_t output_bytes = 0;
+    /// output_bytes over elapsed_seconds.
+    double output_bytes_per_second = 0;
+
+    /// One-line JSON object.
+    std::string to_json() const;
+
+    /// Prometheus text exposition format, metrics prefixed with `loadgen_`.
+    std::string to_prometheus() const;
+};
+
+/// Metrics of a RequestGenerator and of the streams made from it.
+class GeneratorMetrics {
+public:
+    GeneratorMetrics();
+
+    GeneratorMetrics(const GeneratorMetrics &) = delete;
+    GeneratorMetrics &operator=(const GeneratorMetrics &) = delete;
+
+    /// New shard for one more writer thread. Shards live as long as the
+    /// metrics.
+    GeneratorCounters *add_shard();
+
+    /// Counter of the bytes written to the trace (see OutputSink::Options).
+    std::atomic<uint64_t> *output_bytes() { return &output_bytes_; }
+
+    MetricsSnapshot snapshot() const;
+
+private:
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<GeneratorCounters>> shards_;
+    std::atomic<uint64_t> output_bytes_;
+};
+
+/// Writes snapshots of a GeneratorMetrics at a fixed interval from a
+/// background thread, plus one when created and one when stopped.
+///
+/// JSON snapshots are appended to the file one per line. Prometheus
+/// snapshots replace the file (through a rename), as the node exporter
+/// textfile collector expects. Path "-" writes every snapshot to stderr.
+class MetricsReporter {
+public:
+    enum class Format { JSON, PROMETHEUS };
+
+    /// @throws std::runtime_error when the file cannot be written.
+    MetricsReporter(const GeneratorMetrics &metrics, const std::string &path,
+                    Format format, long interval_ms);
+    ~MetricsReporter();
+
+    MetricsReporter(const MetricsReporter &) = delete;
+    MetricsReporter &operator=(const MetricsReporter &) = delete;
+
+    /// Write the last snapshot and stop the thread.
+    void stop();
+
+private:
+    void report();
+    void loop();
+
+    const GeneratorMetrics &metrics_;
+    std::string path_;
+    Format format_;
+    std::chrono::milliseconds interval_;
+    std::unique_ptr<std::ostream> file_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+/// Reporter for the `output.metrics` settings of `config`, or nullptr when
+/// metrics_path is empty.
+/// @throws std::invalid_argument on an unknown metrics_format.
+std::unique_ptr<MetricsReporter>
+make_metrics_reporter(const GeneratorMetrics &metrics,
+                      const RequestGenerator::Configuration &config);
+
+} // namespace workload
+
+#endif
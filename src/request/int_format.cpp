@@ -0,0 +1 @@
+#include "int_format.h"
\ No newline at end of file
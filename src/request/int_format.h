@@ -0,0 +1,77 @@
+#ifndef WORKLOAD_INT_FORMAT_H
+#define WORKLOAD_INT_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace workload {
+
+/// Decimal digits of `value`.
+inline int decimal_length(uint64_t value) {
+    int length = 1;
+    while (value >= 10000) {
+        value /= 10000;
+        length += 4;
+    }
+    if (value >= 1000) {
+        return length + 3;
+    }
+    if (value >= 100) {
+        return length + 2;
+    }
+    return length + (value >= 10);
+}
+
+/// Write the `length` decimal digits of `value` ending at `out + length`,
+/// two digits per step.
+inline void write_digits(char *out, uint64_t value, int length) {
+    static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                      "10111213141516171819"
+                                      "20212223242526272829"
+                                      "30313233343536373839"
+                                      "40414243444546474849"
+                                      "50515253545556575859"
+                                      "60616263646566676869"
+                                      "70717273747576777879"
+                                      "80818283848586878889"
+                                      "90919293949596979899";
+    char *p = out + length;
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + pair, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        std::memcpy(p, DIGIT_PAIRS + value * 2, 2);
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+    while (p > out) {
+        *--p = '0';
+    }
+}
+
+/// Write `value` in decimal, left-padded with '0' to at least `width`
+/// characters like `os << setfill('0') << setw(width) << value`.
+/// @return One past the last character written.
+inline char *write_decimal(char *out, long value, int width = 0) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                   : static_cast<uint64_t>(value);
+    int digits = decimal_length(magnitude);
+    int length = digits + (value < 0);
+    int padding = width > length ? width - length : 0;
+
+    std::memset(out, '0', padding);
+    out += padding;
+    if (value < 0) {
+        *out++ = '-';
+    }
+    write_digits(out, magnitude, digits);
+    return out + digits;
+}
+
+} // namespace workload
+
+#endif
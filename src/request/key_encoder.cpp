@@ -0,0 +1,146 @@
+#include "key_encoder.h"
+#include "counter_engine.h"
+#include "int_format.h"
+#include "scrambled_zipfian_int_distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+KeyEncoder::KeyEncoder(const RequestGenerator::Configuration &config) :
+    width_(static_cast<int>(config.key_width)),
+    min_size_(config.key_min_size), max_size_(config.key_max_size) {
+    if (config.key_width < 0 ||
+        config.key_width > static_cast<long>(MAX_SIZE) - 4) {
+        throw invalid_argument("key_width out of range");
+    }
+    if (config.key_encoding == "DECIMAL") {
+        encoding_ = DECIMAL;
+        if (width_ == 0) {
+            width_ = 10;
+        }
+        if (width_ < 20) {
+            limit_ = 1;
+            for (int i = 0; i < width_; i++) {
+                limit_ *= 10;
+            }
+        }
+    } else if (config.key_encoding == "USER_HASH") {
+        encoding_ = USER_HASH;
+    } else if (config.key_encoding == "BINARY") {
+        encoding_ = BINARY;
+        if (width_ == 0) {
+            width_ = 8;
+        }
+        if (width_ > 8) {
+            throw invalid_argument("BINARY keys take 1 to 8 bytes");
+        }
+    } else if (config.key_encoding == "VARIABLE") {
+        encoding_ = VARIABLE;
+        if (min_size_ < 1 || max_size_ < min_size_ ||
+            max_size_ > static_cast<long>(MAX_SIZE)) {
+            throw invalid_argument("VARIABLE keys need 1 <= key_min_size <= "
+                                   "key_max_size <= 256");
+        }
+        if (config.key_size_distribution == "ZIPFIAN") {
+            size_cdf_.resize(static_cast<size_t>(max_size_ - min_size_ + 1));
+            double sum = 0;
+            for (size_t i = 0; i < size_cdf_.size(); i++) {
+                sum += 1.0 / pow(static_cast<double>(i + 1),
+                                 zipfian_int_distribution<long>::
+                                     ZIPFIAN_CONSTANT);
+                size_cdf_[i] = sum;
+            }
+            for (size_t i = 0; i < size_cdf_.size(); i++) {
+                size_cdf_[i] /= sum;
+            }
+        } else if (config.key_size_distribution != "UNIFORM") {
+            throw invalid_argument("Unknown key_size_distribution: " +
+                                   config.key_size_distribution);
+        }
+    } else {
+        throw invalid_argument("Unknown key_encoding: " +
+                               config.key_encoding);
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// encode()
+// ────────────────────────────────────────────────────────────────────────
+// Digits go through the two-digit table of int_format.h straight into the
+// output. DECIMAL keys that fit the width skip the length computation.
+
+static const char USER_PREFIX[] = "user";
+
+size_t KeyEncoder::encode(long key, char *out) const {
+    switch (encoding_) {
+    case DECIMAL:
+        if (static_cast<uint64_t>(key) < limit_) {
+            write_digits(out, static_cast<uint64_t>(key), width_);
+            return static_cast<size_t>(width_);
+        }
+        return static_cast<size_t>(write_decimal(out, key, width_) - out);
+    case USER_HASH: {
+        memcpy(out, USER_PREFIX, sizeof(USER_PREFIX) - 1);
+        uint64_t hash = scrambled_zipfian_int_distribution<long>::fnvhash64(
+            static_cast<uint64_t>(key));
+        int digits = decimal_length(hash);
+        int length = digits > width_ ? digits : width_;
+        write_digits(out + sizeof(USER_PREFIX) - 1, hash, length);
+        return sizeof(USER_PREFIX) - 1 + static_cast<size_t>(length);
+    }
+    case BINARY: {
+        uint64_t value = static_cast<uint64_t>(key);
+        if (width_ < 8 && (value >> (8 * width_)) != 0) {
+            throw runtime_error("Key does not fit in key_width bytes");
+        }
+        for (int i = width_ - 1; i >= 0; i--) {
+            out[i] = static_cast<char>(value);
+            value >>= 8;
+        }
+        return static_cast<size_t>(width_);
+    }
+    case VARIABLE:
+        return encode_variable(key, out);
+    }
+    return 0;
+}
+
+size_t KeyEncoder::encode_variable(long key, char *out) const {
+    // The size and the letters come from a stream of the key alone.
+    rfunc::counter_engine engine(static_cast<uint64_t>(key));
+    uint64_t bits = engine();
+    long size;
+    if (size_cdf_.empty()) {
+        size = min_size_ +
+               static_cast<long>(bits % static_cast<uint64_t>(
+                                            max_size_ - min_size_ + 1));
+    } else {
+        // 53 random bits in [0, 1).
+        double u = static_cast<double>(bits >> 11) / 9007199254740992.0;
+        size_t i = 0;
+        while (i + 1 < size_cdf_.size() && size_cdf_[i] <= u) {
+            i++;
+        }
+        size = min_size_ + static_cast<long>(i);
+    }
+
+    char *p = write_decimal(out, key, width_);
+    // Up to eight letters per draw, each byte scaled to [0, 26).
+    while (p < out + size) {
+        uint64_t letters = engine();
+        int n = static_cast<int>(min<ptrdiff_t>(8, out + size - p));
+        for (int i = 0; i < n; i++) {
+            p[i] = static_cast<char>('a' + (((letters >> (8 * i)) & 0xff) *
+                                             26 >> 8));
+        }
+        p += n;
+    }
+    return static_cast<size_t>(p - out);
+}
+
+} // namespace workload
@@ -0,0 +1,69 @@
+#ifndef WORKLOAD_KEY_ENCODER_H
+#define WORKLOAD_KEY_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "request_generator.h"
+
+namespace workload {
+
+/// Bytes of the keys handed to stores (`workload.key_encoding`).
+///
+/// The generator draws integer keys; the encoding sets their size and byte
+/// layout, and with that the comparator behaviour of the store:
+/// - "DECIMAL": digits zero-padded to key_width (default 10).
+/// - "USER_HASH": "user" followed by the FNV hash of the key in decimal,
+///   zero-padded to key_width (default none), as YCSB names its keys. Like
+///   in YCSB, distinct keys may share a hash, which is unlikely below
+///   billions of keys.
+/// - "BINARY": the key as a big-endian integer of key_width bytes (1 to 8,
+///   default 8), so byte order is numeric order.
+/// - "VARIABLE": the digits of the key, zero-padded to key_width (default
+///   none), followed by letters up to a length drawn from
+///   key_size_distribution ("UNIFORM" or "ZIPFIAN", short keys most
+///   frequent) over [key_min_size, key_max_size]. Keys longer than their
+///   digits are written in full.
+///
+/// Encodings are pure functions of the key: every stream, thread and run
+/// encodes a key the same way. encode() is const and writes into the
+/// caller's buffer, so one encoder can be shared between threads.
+class KeyEncoder {
+public:
+    /// Longest encoded key, in bytes.
+    static const size_t MAX_SIZE = 256;
+
+    /// @throws std::invalid_argument for unknown encodings and sizes out of
+    /// range.
+    explicit KeyEncoder(const RequestGenerator::Configuration &config);
+
+    /// Write the encoding of `key` to `out`, which holds MAX_SIZE bytes.
+    /// @return Its length.
+    /// @throws std::runtime_error for BINARY keys that do not fit in
+    /// key_width bytes.
+    size_t encode(long key, char *out) const;
+
+    /// False for BINARY keys, which may hold any byte; the others are
+    /// letters and digits.
+    bool text() const { return encoding_ != BINARY; }
+
+private:
+    enum Encoding { DECIMAL, USER_HASH, BINARY, VARIABLE };
+
+    size_t encode_variable(long key, char *out) const;
+
+    Encoding encoding_;
+    int width_;
+    /// DECIMAL keys below it have at most width_ digits (0: no limit).
+    uint64_t limit_ = 0;
+    long min_size_;
+    long max_size_;
+    /// ZIPFIAN VARIABLE sizes: probability of the sizes up to
+    /// min_size_ + i, empty for UNIFORM.
+    std::vector<double> size_cdf_;
+};
+
+} // namespace workload
+
+#endif
@@ -0,0 +1,169 @@
+#include "live_key_set.h"
+
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+// Bits set in each byte of `x`, by halving. Portable builds do not have a
+// popcount instruction, and the builtin falls back to a library call.
+static uint64_t byte_counts(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+}
+
+static int popcount(uint64_t x) {
+    return static_cast<int>((byte_counts(x) * 0x0101010101010101ULL) >> 56);
+}
+
+// Position of the `k`-th (from 0) set bit of `x`: byte `i` of `below` counts
+// the set bits of bytes 0 to i, which finds the byte, then its bits.
+static int select_in_word(uint64_t x, int k) {
+    uint64_t below = byte_counts(x) * 0x0101010101010101ULL;
+    int shift = 0;
+    while (static_cast<int>((below >> shift) & 0xff) <= k) {
+        shift += 8;
+    }
+    if (shift > 0) {
+        k -= static_cast<int>((below >> (shift - 8)) & 0xff);
+    }
+    for (x >>= shift;; x >>= 1, shift++) {
+        if ((x & 1) && k-- == 0) {
+            return shift;
+        }
+    }
+}
+
+bool LiveKeySet::erase(long key) {
+    if (key < 0) {
+        throw invalid_argument("LiveKeySet keys are non-negative");
+    }
+    size_t word = static_cast<size_t>(key) / 64;
+    if (word >= words_.size()) {
+        grow(word / BLOCK_WORDS + 1);
+    }
+    uint64_t bit = 1ULL << (key % 64);
+    if (words_[word] & bit) {
+        return false;
+    }
+    words_[word] |= bit;
+    deleted_++;
+    for (size_t i = word / BLOCK_WORDS + 1; i < tree_.size(); i += i & -i) {
+        tree_[i]++;
+    }
+    return true;
+}
+
+long LiveKeySet::deleted_below(long key) const {
+    size_t word = static_cast<size_t>(key) / 64;
+    if (word >= words_.size()) {
+        return deleted_;
+    }
+    size_t block = word / BLOCK_WORDS;
+    long deleted = 0;
+    for (size_t i = block; i > 0; i -= i & -i) {
+        deleted += tree_[i];
+    }
+    for (size_t w = block * BLOCK_WORDS; w < word; w++) {
+        deleted += popcount(words_[w]);
+    }
+    return deleted + popcount(words_[word] & ((1ULL << (key % 64)) - 1));
+}
+
+long LiveKeySet::select(long rank) const {
+    // Walk down the tree for the last block that ends with at most `rank`
+    // live keys before it; node block + step covers exactly `step` blocks.
+    size_t blocks = tree_.empty() ? 0 : tree_.size() - 1;
+    size_t block = 0;
+    long remaining = rank;
+    for (size_t step = blocks; step > 0; step >>= 1) {
+        if (block + step > blocks) {
+            continue;
+        }
+        long live = static_cast<long>(step) * BLOCK_KEYS -
+                    static_cast<long>(tree_[block + step]);
+        // Branch free: the comparison is a coin flip for random ranks.
+        long take = -static_cast<long>(live <= remaining);
+        block += step & static_cast<size_t>(take);
+        remaining -= live & take;
+    }
+    if (block == blocks) {
+        return static_cast<long>(blocks) * BLOCK_KEYS + remaining;
+    }
+
+    for (size_t w = block * BLOCK_WORDS;; w++) {
+        long live = 64 - popcount(words_[w]);
+        if (remaining < live) {
+            return static_cast<long>(w) * 64 +
+                   select_in_word(~words_[w], static_cast<int>(remaining));
+        }
+        remaining -= live;
+    }
+}
+
+void LiveKeySet::grow(size_t blocks) {
+    size_t size = 1;
+    while (size < blocks) {
+        size <<= 1;
+    }
+    words_.resize(size * BLOCK_WORDS, 0);
+
+    // Rebuild the tree in linear time: every node passes its total on to
+    // its parent.
+    tree_.assign(size + 1, 0);
+    for (size_t b = 0; b < size; b++) {
+        uint64_t deleted = 0;
+        for (size_t w = b * BLOCK_WORDS; w < (b + 1) * BLOCK_WORDS; w++) {
+            deleted += static_cast<uint64_t>(popcount(words_[w]));
+        }
+        tree_[b + 1] += deleted;
+        size_t parent = (b + 1) + ((b + 1) & -(b + 1));
+        if (parent <= size) {
+            tree_[parent] += tree_[b + 1];
+        }
+    }
+}
+
+ostream &operator<<(ostream &os, const LiveKeySet &set) {
+    size_t used = 0;
+    for (size_t w = 0; w < set.words_.size(); w++) {
+        used += set.words_[w] != 0;
+    }
+    os << set.words_.size() << ' ' << used;
+    for (size_t w = 0; w < set.words_.size(); w++) {
+        if (set.words_[w] != 0) {
+            os << ' ' << w << ' ' << set.words_[w];
+        }
+    }
+    return os;
+}
+
+istream &operator>>(istream &is, LiveKeySet &set) {
+    size_t size, used;
+    if (!(is >> size >> used)) {
+        return is;
+    }
+    vector<uint64_t> words(size, 0);
+    long deleted = 0;
+    for (size_t i = 0; i < used; i++) {
+        size_t w;
+        uint64_t word;
+        if (!(is >> w >> word) || w >= size) {
+            is.setstate(ios::failbit);
+            return is;
+        }
+        words[w] = word;
+        deleted += popcount(word);
+    }
+    set.words_.swap(words);
+    set.deleted_ = deleted;
+    set.tree_.clear();
+    if (size > 0) {
+        set.grow((size + LiveKeySet::BLOCK_WORDS - 1) /
+                 LiveKeySet::BLOCK_WORDS);
+    }
+    return is;
+}
+
+} // namespace workload
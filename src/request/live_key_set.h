@@ -0,0 +1,82 @@
+#ifndef WORKLOAD_LIVE_KEY_SET_H
+#define WORKLOAD_LIVE_KEY_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace workload {
+
+/// Keys 0, 1, 2, ... minus the deleted ones, with rank and select over the
+/// keys still live.
+///
+/// Deleted keys are bits of a bitmap that grows up to the largest deleted
+/// key. Every BLOCK_KEYS keys, a Fenwick tree counts the deletions of the
+/// block, so the cost is about 1.13 bits per key, and both rank() and
+/// select() take one tree walk (log2 of the number of blocks steps) plus a
+/// few popcounts. Keys past the bitmap are all live.
+///
+/// Single writer: erase() must not run concurrently with any other call.
+class LiveKeySet {
+public:
+    /// Keys per Fenwick tree entry.
+    static const long BLOCK_KEYS = 512;
+
+    LiveKeySet() : deleted_(0) {}
+
+    /// Delete `key` (>= 0).
+    /// @return false when it was already deleted.
+    bool erase(long key);
+
+    bool contains(long key) const {
+        if (key < 0) {
+            return false;
+        }
+        size_t word = static_cast<size_t>(key) / 64;
+        return word >= words_.size() || !((words_[word] >> (key % 64)) & 1);
+    }
+
+    /// Number of live keys below `key`.
+    long rank(long key) const {
+        return key <= 0 ? 0 : key - deleted_below(key);
+    }
+
+    /// The live key of rank `rank` (>= 0): the one with `rank` live keys
+    /// below it.
+    long select(long rank) const;
+
+    /// Number of deleted keys.
+    long deleted() const { return deleted_; }
+
+    /// Bytes held by the bitmap and the tree.
+    size_t memory_bytes() const {
+        return words_.capacity() * sizeof(uint64_t) +
+               tree_.capacity() * sizeof(uint64_t);
+    }
+
+    /// Text state: the bitmap size, then the position and bits of every
+    /// word with a deleted key.
+    friend std::ostream &operator<<(std::ostream &os, const LiveKeySet &set);
+
+    /// Replace the set with one written by operator<<.
+    friend std::istream &operator>>(std::istream &is, LiveKeySet &set);
+
+private:
+    static const size_t BLOCK_WORDS = BLOCK_KEYS / 64;
+
+    long deleted_below(long key) const;
+    void grow(size_t blocks);
+
+    /// One bit per key, set when the key is deleted.
+    std::vector<uint64_t> words_;
+    /// 1-based Fenwick tree of the deletions per block; its size is a power
+    /// of two plus one.
+    std::vector<uint64_t> tree_;
+    long deleted_;
+};
+
+} // namespace workload
+
+#endif
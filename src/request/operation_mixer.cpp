@@ -0,0 +1,75 @@
+#include "operation_mixer.h"
+
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+OperationMixer::OperationMixer(
+    const std::vector<std::pair<loadgen::types::Type, double>> &weights,
+    Method method) :
+    method_(method) {
+    double sum = 0;
+    for (size_t i = 0; i < weights.size(); i++) {
+        if (weights[i].second > 0) {
+            if (size_ == MAX_TYPES) {
+                throw invalid_argument("Too many operation types");
+            }
+            types_[size_++] = weights[i].first;
+            sum += weights[i].second;
+        }
+    }
+
+    // Normalized in the order of `weights`; CUMULATIVE selection performs the
+    // same floating point steps as RequestGenerator::next_operation.
+    size_t n = 0;
+    for (size_t i = 0; i < weights.size(); i++) {
+        if (weights[i].second > 0) {
+            probabilities_[n++] = weights[i].second / sum;
+        }
+    }
+    if (method_ == Method::CUMULATIVE || size_ == 0) {
+        return;
+    }
+
+    // Vose: scale the probabilities to a mean of 1, then pair every column
+    // below 1 with one above it, which gives it the missing share.
+    double scaled[MAX_TYPES];
+    size_t small[MAX_TYPES], large[MAX_TYPES];
+    size_t n_small = 0, n_large = 0;
+    for (size_t i = 0; i < size_; i++) {
+        scaled[i] = probabilities_[i] * static_cast<double>(size_);
+        aliases_[i] = static_cast<uint8_t>(i);
+        if (scaled[i] < 1.0) {
+            small[n_small++] = i;
+        } else {
+            large[n_large++] = i;
+        }
+    }
+    while (n_small > 0 && n_large > 0) {
+        size_t s = small[--n_small];
+        size_t l = large[--n_large];
+        probabilities_[s] = scaled[s];
+        aliases_[s] = static_cast<uint8_t>(l);
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0) {
+            small[n_small++] = l;
+        } else {
+            large[n_large++] = l;
+        }
+    }
+    // Whatever is left is 1 up to rounding.
+    while (n_large > 0) {
+        probabilities_[large[--n_large]] = 1.0;
+    }
+    while (n_small > 0) {
+        probabilities_[small[--n_small]] = 1.0;
+    }
+}
+
+void OperationMixer::throw_unmatched() {
+    throw invalid_argument("No operation matches the draw; check the "
+                           "operation proportions");
+}
+
+} // namespace workload
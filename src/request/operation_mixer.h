@@ -0,0 +1,87 @@
+#ifndef WORKLOAD_OPERATION_MIXER_H
+#define WORKLOAD_OPERATION_MIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "../types/types.h"
+
+namespace workload {
+
+/// Operation type selection from the configured proportions, compiled once
+/// by RequestGenerator::init().
+///
+/// The mixer is a fixed-size table, so pipelines copy it without allocating.
+/// Both methods turn one uniform draw in [0, 1) into a type:
+/// - CUMULATIVE scans the normalized weights in order, the historical
+///   selection, so existing traces are reproduced. O(number of types).
+/// - ALIAS looks the draw up in a Vose alias table: the integer part of
+///   `u * size` picks a column and the fractional part picks between the
+///   column and its alias. O(1).
+class OperationMixer {
+public:
+    enum class Method { CUMULATIVE, ALIAS };
+
+    /// Operation types a mixer can hold.
+    static const size_t MAX_TYPES = 8;
+
+    /// Mixer with no operation; select() throws.
+    OperationMixer() {}
+
+    /// @param[in] weights  Types and their weights; types with a weight <= 0
+    /// are left out.
+    /// @throws std::invalid_argument with more than MAX_TYPES weights.
+    OperationMixer(
+        const std::vector<std::pair<loadgen::types::Type, double>> &weights,
+        Method method);
+
+    /// Type for the uniform draw `u` in [0, 1).
+    /// @throws std::invalid_argument when no operation matches (no positive
+    /// weight).
+    loadgen::types::Type select(double u) const {
+        if (method_ == Method::ALIAS) {
+            return select_alias(u);
+        }
+        for (size_t i = 0; i < size_; i++) {
+            if (u < probabilities_[i]) {
+                return types_[i];
+            }
+            u -= probabilities_[i];
+        }
+        throw_unmatched();
+    }
+
+    /// Number of operation types with a positive weight.
+    size_t size() const { return size_; }
+
+private:
+    loadgen::types::Type select_alias(double u) const {
+        if (size_ == 0) {
+            throw_unmatched();
+        }
+        double scaled = u * static_cast<double>(size_);
+        size_t column = static_cast<size_t>(scaled);
+        if (column >= size_) {
+            column = size_ - 1;
+        }
+        return scaled - static_cast<double>(column) < probabilities_[column]
+                   ? types_[column]
+                   : types_[aliases_[column]];
+    }
+
+    [[noreturn]] static void throw_unmatched();
+
+    Method method_ = Method::CUMULATIVE;
+    size_t size_ = 0;
+    loadgen::types::Type types_[MAX_TYPES] = {};
+    /// CUMULATIVE: normalized weights. ALIAS: probability of keeping the
+    /// column rather than taking its alias.
+    double probabilities_[MAX_TYPES] = {};
+    uint8_t aliases_[MAX_TYPES] = {};
+};
+
+} // namespace workload
+
+#endif
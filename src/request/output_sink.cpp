@@ -0,0 +1,258 @@
+#include "output_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace workload {
+using namespace std;
+
+static const size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// ────────────────────────────────────────────────────────────────────────
+// OutputSink
+// ────────────────────────────────────────────────────────────────────────
+OutputSink::OutputSink(const Options &options) : options_(options) {
+    size_t capacity = max(options_.buffer_size, DIRECT_IO_ALIGNMENT);
+    capacity = (capacity + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT *
+               DIRECT_IO_ALIGNMENT;
+    allocate(buffers_[0], capacity);
+    allocate(buffers_[1], capacity);
+    pos_ = buffers_[0].data;
+    end_ = pos_ + buffers_[0].capacity;
+
+    if (options_.background) {
+        writer_ = thread(&OutputSink::writer_loop, this);
+    }
+}
+
+OutputSink::~OutputSink() {
+    if (writer_.joinable()) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+    }
+    free(buffers_[0].data);
+    free(buffers_[1].data);
+}
+
+void OutputSink::allocate(Buffer &buffer, size_t capacity) {
+    void *data = nullptr;
+    if (posix_memalign(&data, DIRECT_IO_ALIGNMENT, capacity) != 0) {
+        throw bad_alloc();
+    }
+    free(buffer.data);
+    buffer.data = static_cast<char *>(data);
+    buffer.capacity = capacity;
+}
+
+void OutputSink::write(const char *data, size_t n) {
+    while (n > 0) {
+        size_t room = static_cast<size_t>(end_ - pos_);
+        if (room == 0) {
+            make_room(1);
+            continue;
+        }
+        size_t chunk = min(room, n);
+        memcpy(pos_, data, chunk);
+        pos_ += chunk;
+        data += chunk;
+        n -= chunk;
+    }
+}
+
+void OutputSink::make_room(size_t n) {
+    Buffer &current = buffers_[current_];
+    size_t used = static_cast<size_t>(pos_ - current.data);
+    size_t ready = used / alignment_ * alignment_;
+
+    if (ready > 0) {
+        submit(ready);
+    } else {
+        wait_idle();
+    }
+
+    // The unaligned tail moves to the start of the buffer filled next.
+    Buffer &next = buffers_[current_];
+    size_t tail = used - ready;
+    if (next.capacity < tail + n) {
+        Buffer grown;
+        allocate(grown, (tail + n + DIRECT_IO_ALIGNMENT - 1) /
+                            DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT);
+        memcpy(grown.data, current.data + ready, tail);
+        free(next.data);
+        next = grown;
+    } else if (&next != &current) {
+        memcpy(next.data, current.data + ready, tail);
+    } else {
+        memmove(next.data, current.data + ready, tail);
+    }
+    pos_ = next.data + tail;
+    end_ = next.data + next.capacity;
+}
+
+void OutputSink::submit(size_t n) {
+    const char *data = buffers_[current_].data;
+    count_written(n);
+    if (!options_.background) {
+        write_out(data, n);
+        return;
+    }
+
+    // Wait for the writer to release the other buffer, then swap.
+    unique_lock<mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return pending_ == nullptr; });
+    if (error_) {
+        rethrow_exception(error_);
+    }
+    pending_ = data;
+    pending_size_ = n;
+    current_ = 1 - current_;
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void OutputSink::wait_idle() {
+    if (!options_.background) {
+        return;
+    }
+    unique_lock<mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return pending_ == nullptr; });
+    if (error_) {
+        rethrow_exception(error_);
+    }
+}
+
+void OutputSink::writer_loop() {
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this]() { return pending_ != nullptr || stop_; });
+        if (pending_ == nullptr) {
+            return;
+        }
+        const char *data = pending_;
+        size_t size = pending_size_;
+        lock.unlock();
+        try {
+            write_out(data, size);
+        } catch (...) {
+            lock.lock();
+            error_ = current_exception();
+            pending_ = nullptr;
+            cv_.notify_all();
+            continue;
+        }
+        lock.lock();
+        pending_ = nullptr;
+        cv_.notify_all();
+    }
+}
+
+void OutputSink::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+
+    Buffer &current = buffers_[current_];
+    size_t used = static_cast<size_t>(pos_ - current.data);
+    size_t ready = used / alignment_ * alignment_;
+    if (ready > 0) {
+        submit(ready);
+    }
+    wait_idle();
+    if (used > ready) {
+        write_tail(current.data + ready, used - ready);
+        count_written(used - ready);
+    }
+    pos_ = end_ = nullptr;
+    close_out();
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// FdOutputSink
+// ────────────────────────────────────────────────────────────────────────
+FdOutputSink::FdOutputSink(const std::string &path, const Options &options) :
+    OutputSink(options), fd_(-1), owns_fd_(true), direct_(false) {
+    if (path == "-") {
+        fd_ = STDOUT_FILENO;
+        owns_fd_ = false;
+        return;
+    }
+
+    struct stat st;
+    bool regular = stat(path.c_str(), &st) != 0 || S_ISREG(st.st_mode);
+    int flags = O_WRONLY | O_CREAT | (regular ? O_TRUNC : 0);
+
+#ifdef O_DIRECT
+    if (options.direct_io && regular) {
+        fd_ = open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) {
+        fd_ = open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        throw runtime_error("Cannot open " + path + ": " + strerror(errno));
+    }
+    if (direct_) {
+        set_alignment(DIRECT_IO_ALIGNMENT);
+    }
+}
+
+FdOutputSink::~FdOutputSink() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void FdOutputSink::write_out(const char *data, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::write(fd_, data, n);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw runtime_error(string("Trace write failed: ") +
+                                strerror(errno));
+        }
+        data += written;
+        n -= static_cast<size_t>(written);
+    }
+}
+
+void FdOutputSink::write_tail(const char *data, size_t n) {
+#ifdef O_DIRECT
+    // O_DIRECT only takes whole aligned blocks; the last one goes through
+    // the page cache.
+    if (direct_) {
+        fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+        direct_ = false;
+    }
+#endif
+    write_out(data, n);
+}
+
+void FdOutputSink::close_out() {
+    if (owns_fd_ && fd_ >= 0) {
+        if (::close(fd_) != 0) {
+            fd_ = -1;
+            throw runtime_error(string("Trace close failed: ") +
+                                strerror(errno));
+        }
+    }
+    fd_ = -1;
+}
+
+} // namespace workload
@@ -0,0 +1,125 @@
+#ifndef WORKLOAD_OUTPUT_SINK_H
+#define WORKLOAD_OUTPUT_SINK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace workload {
+
+/// Destination of exported traces.
+///
+/// Writers format straight into the sink buffer through reserve()/advance().
+/// Full buffers are handed to write_out(), either inline or, with
+/// `background` set, on a writer thread while the producer fills the second
+/// buffer.
+class OutputSink {
+public:
+    struct Options {
+        /// Size of each of the two buffers.
+        size_t buffer_size = 4 << 20;
+        /// Write full buffers from a background thread.
+        bool background = true;
+        /// Open regular files with O_DIRECT (falls back to buffered I/O when
+        /// the file system refuses it).
+        bool direct_io = false;
+        /// Counter increased by the bytes handed to the destination, or
+        /// nullptr.
+        std::atomic<uint64_t> *written = nullptr;
+    };
+
+    explicit OutputSink(const Options &options);
+    virtual ~OutputSink();
+
+    /// Pointer to at least `n` writable bytes, committed with advance().
+    char *reserve(size_t n) {
+        if (static_cast<size_t>(end_ - pos_) < n) {
+            make_room(n);
+        }
+        return pos_;
+    }
+
+    /// Commit `n` bytes written at the pointer returned by reserve().
+    void advance(size_t n) { pos_ += n; }
+
+    /// Append `n` bytes.
+    void write(const char *data, size_t n);
+
+    /// Write out everything buffered and release the destination. Called by
+    /// the destructor of concrete sinks; errors are only reported here.
+    void close();
+
+protected:
+    /// Write `n` bytes to the destination.
+    virtual void write_out(const char *data, size_t n) = 0;
+
+    /// Write the final bytes; `n` may break the alignment of write_out().
+    virtual void write_tail(const char *data, size_t n) { write_out(data, n); }
+
+    /// Release the destination after the last write.
+    virtual void close_out() {}
+
+    /// Sizes passed to write_out() are multiples of `alignment`.
+    void set_alignment(size_t alignment) { alignment_ = alignment; }
+
+private:
+    struct Buffer {
+        char *data = nullptr;
+        size_t capacity = 0;
+    };
+
+    void make_room(size_t n);
+    void submit(size_t n);
+    void count_written(size_t n) {
+        if (options_.written != nullptr) {
+            options_.written->fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    void wait_idle();
+    void writer_loop();
+    static void allocate(Buffer &buffer, size_t capacity);
+
+    Options options_;
+    size_t alignment_ = 1;
+    Buffer buffers_[2];
+    int current_ = 0;
+    char *pos_ = nullptr;
+    char *end_ = nullptr;
+    bool closed_ = false;
+
+    std::thread writer_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    const char *pending_ = nullptr;
+    size_t pending_size_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+/// Sink writing to a file descriptor: regular files, named pipes or stdout.
+class FdOutputSink : public OutputSink {
+public:
+    /// @param[in] path  File or FIFO to write to, "-" for stdout.
+    FdOutputSink(const std::string &path, const Options &options);
+    ~FdOutputSink();
+
+protected:
+    void write_out(const char *data, size_t n) override;
+    void write_tail(const char *data, size_t n) override;
+    void close_out() override;
+
+private:
+    int fd_;
+    bool owns_fd_;
+    bool direct_;
+};
+
+} // namespace workload
+
+#endif
@@ -4,6 +4,8 @@ namespace rfunc {
 
 Distribution str_to_dist(std::string str) { return __STR_TO_DIST.at(str); }
 
+Engine str_to_engine(std::string str) { return __STR_TO_ENGINE.at(str); }
+
 RandFunction uniform_distribution_rand(long min_value, long max_value,
                                        long seed) {
     std::mt19937 generator(seed);
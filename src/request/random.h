@@ -5,6 +5,7 @@
 #include <random>
 #include <unordered_map>
 #include "acknowledged_counter.h"
+#include "engines.h"
 #include "zipfian_int_distribution.h"
 #include "scrambled_zipfian_int_distribution.h"
 #include "skewed_latest_int_distribution.h"
@@ -31,6 +32,18 @@ const std::unordered_map<std::string, Distribution>
 
 Distribution str_to_dist(std::string str);
 
+enum Engine {
+    MT19937,
+    XOSHIRO256SS,
+    PCG64
+};
+const std::unordered_map<std::string, Engine>
+    __STR_TO_ENGINE({{"MT19937", Engine::MT19937},
+                     {"XOSHIRO256SS", Engine::XOSHIRO256SS},
+                     {"PCG64", Engine::PCG64}});
+
+Engine str_to_engine(std::string str);
+
 RandFunction uniform_distribution_rand(long min_value, long max_value,
                                        long seed = std::mt19937::default_seed);
 DoubleRandFunction
@@ -1,24 +1,53 @@
 #include "request_generator.h"
+#include "arrival_process.h"
+#include "binary_trace_format.h"
+#include "generator_metrics.h"
+#include "key_encoder.h"
+#include "live_key_set.h"
+#include "output_sink.h"
+#include "request_pipeline.h"
+#include "request_stream.h"
+#include "trace_writer.h"
+#include "value_pool.h"
 #include "../../external/toml11/include/toml.hpp"
 
 #include <iostream>
 #include <iomanip>
+#include <limits>
+#include <sstream>
 #include <thread>
 #include <cassert>
 
 #define PBSTR "||||||||||||||||||||||||||||||||||||||||||||||||||||||||||||"
 #define PBWIDTH 60
 
-static void export_print_progress(double *percentage) {
-    while ((*percentage) < 1.0) {
-        double val = (*percentage) * 100;
-        int lpad = (int)((*percentage) * PBWIDTH);
-        int rpad = PBWIDTH - lpad;
-        printf("\r%.2f%% [%.*s%*s]", val, lpad, PBSTR, rpad, "");
-        fflush(stdout);
+static void print_progress(double percentage, FILE *stream) {
+    double val = percentage * 100;
+    int lpad = (int)(percentage * PBWIDTH);
+    int rpad = PBWIDTH - lpad;
+    fprintf(stream, "\r%.2f%% [%.*s%*s]", val, lpad, PBSTR, rpad, "");
+    fflush(stream);
+}
+
+// Draws the progress of `total` requests from the request counters until
+// `done` is set.
+static void export_print_progress(const workload::GeneratorMetrics *metrics,
+                                  double total, const std::atomic<bool> *done,
+                                  FILE *stream) {
+    using workload::GeneratorCounters;
+    while (!done->load()) {
+        workload::MetricsSnapshot snapshot = metrics->snapshot();
+        double count = 0;
+        for (int c = GeneratorCounters::LOADED;
+             c <= GeneratorCounters::MULTI_GETS; c++) {
+            count += snapshot.counters[c];
+        }
+        print_progress(total > 0 ? std::min(count / total, 1.0) : 0, stream);
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-    std::cout << std::endl;
+    print_progress(1.0, stream);
+    fprintf(stream, "\n");
+    fflush(stream);
 }
 
 namespace workload {
@@ -43,12 +72,12 @@ RequestGenerator::RequestGenerator(const std::string &config_path,
 // ────────────────────────────────────────────────────────────────────────
 RequestGenerator::RequestGenerator(
     const std::string &export_path, bool gen_values, long value_min_size,
-    long value_max_size, long key_seed, long operation_seed, int n_records,
-    int n_operations, const std::string &data_distribution,
+    long value_max_size, long key_seed, long operation_seed, long n_records,
+    long n_operations, const std::string &data_distribution,
     double read_proportion, double update_proportion, double insert_proportion,
     double scan_proportion, long scan_seed,
-    const std::string &scan_length_distribution, int min_scan_length,
-    int max_scan_length) :
+    const std::string &scan_length_distribution, long min_scan_length,
+    long max_scan_length) :
     config_(), initialized_(false), phase_(Phase::LOADING), loading_index_(0),
     operations_index_(0), n_requests_(0), insert_key_sequence_(nullptr) {
     config_.export_path = export_path;
@@ -71,6 +100,178 @@ RequestGenerator::RequestGenerator(
     initialize();
 }
 
+// ────────────────────────────────────────────────────────────────────────
+// Phases
+// ────────────────────────────────────────────────────────────────────────
+// A `[[workload.phases]]` table, every setting it leaves out taken from
+// `base`.
+static RequestGenerator::PhaseConfiguration
+load_phase(const toml::value &table,
+           const RequestGenerator::Configuration &base, size_t index) {
+    RequestGenerator::PhaseConfiguration phase;
+    phase.name =
+        toml::find_or<string>(table, "name", "phase" + to_string(index));
+    phase.n_operations = toml::find<long>(table, "n_operations");
+    phase.duration_ms = toml::find_or<long>(table, "duration_ms", 0L);
+    phase.data_distribution = toml::find_or<string>(
+        table, "data_distribution", base.data_distribution);
+    phase.read_proportion =
+        toml::find_or<double>(table, "read_proportion", base.read_proportion);
+    phase.update_proportion = toml::find_or<double>(
+        table, "update_proportion", base.update_proportion);
+    phase.insert_proportion = toml::find_or<double>(
+        table, "insert_proportion", base.insert_proportion);
+    phase.scan_proportion =
+        toml::find_or<double>(table, "scan_proportion", base.scan_proportion);
+    phase.delete_proportion = toml::find_or<double>(
+        table, "delete_proportion", base.delete_proportion);
+    phase.read_modify_write_proportion =
+        toml::find_or<double>(table, "read_modify_write_proportion",
+                              base.read_modify_write_proportion);
+    phase.multi_get_proportion = toml::find_or<double>(
+        table, "multi_get_proportion", base.multi_get_proportion);
+    phase.scan_length_distribution = toml::find_or<string>(
+        table, "scan_length_distribution", base.scan_length_distribution);
+    phase.min_scan_length =
+        toml::find_or<long>(table, "min_scan_length", base.min_scan_length);
+    phase.max_scan_length =
+        toml::find_or<long>(table, "max_scan_length", base.max_scan_length);
+    phase.multi_get_size_distribution =
+        toml::find_or<string>(table, "multi_get_size_distribution",
+                              base.multi_get_size_distribution);
+    phase.min_multi_get_size = toml::find_or<long>(
+        table, "min_multi_get_size", base.min_multi_get_size);
+    phase.max_multi_get_size = toml::find_or<long>(
+        table, "max_multi_get_size", base.max_multi_get_size);
+    phase.gen_values =
+        toml::find_or<bool>(table, "gen_values", base.gen_values);
+    phase.value_min_size =
+        toml::find_or<long>(table, "value_min_size", base.value_min_size);
+    phase.value_max_size =
+        toml::find_or<long>(table, "value_max_size", base.value_max_size);
+    return phase;
+}
+
+// Seed of phase `index` in SEQUENTIAL mode. Counter stream 2^32 + index
+// keeps the phase seeds apart from those of make_streams().
+static long phase_seed(long seed, size_t index) {
+    rfunc::counter_engine engine(static_cast<uint64_t>(seed),
+                                 (1ULL << 32) + index);
+    return static_cast<long>(engine());
+}
+
+// Configuration of the pipeline of phase `index`: `base` with the phase
+// settings. SEQUENTIAL phases draw from their own seeds so that no phase
+// replays the draws of another; COUNTER requests already differ by index.
+static RequestGenerator::Configuration
+apply_phase(const RequestGenerator::Configuration &base,
+            const RequestGenerator::PhaseConfiguration &phase, size_t index) {
+    RequestGenerator::Configuration config = base;
+    config.phases.clear();
+    config.n_operations = phase.n_operations;
+    config.data_distribution = phase.data_distribution;
+    config.read_proportion = phase.read_proportion;
+    config.update_proportion = phase.update_proportion;
+    config.insert_proportion = phase.insert_proportion;
+    config.scan_proportion = phase.scan_proportion;
+    config.delete_proportion = phase.delete_proportion;
+    config.read_modify_write_proportion = phase.read_modify_write_proportion;
+    config.multi_get_proportion = phase.multi_get_proportion;
+    config.scan_length_distribution = phase.scan_length_distribution;
+    config.min_scan_length = phase.min_scan_length;
+    config.max_scan_length = phase.max_scan_length;
+    config.multi_get_size_distribution = phase.multi_get_size_distribution;
+    config.min_multi_get_size = phase.min_multi_get_size;
+    config.max_multi_get_size = phase.max_multi_get_size;
+    config.gen_values = phase.gen_values;
+    config.value_min_size = phase.value_min_size;
+    config.value_max_size = phase.value_max_size;
+    if (base.rng_mode != "COUNTER") {
+        config.key_seed = phase_seed(base.key_seed, index);
+        config.operation_seed = phase_seed(base.operation_seed, index);
+        config.scan_seed = phase_seed(base.scan_seed, index);
+        config.multi_get_seed = phase_seed(base.multi_get_seed, index);
+        if (base.value_generator != "DERIVED") {
+            config.value_seed = phase_seed(base.value_seed, index);
+        }
+    }
+    return config;
+}
+
+// Mixer of the operation proportions of `config`, whose multi-get settings
+// are checked when it has multi-gets.
+static OperationMixer
+make_operation_mixer(const RequestGenerator::Configuration &config) {
+    // Types without a positive proportion are left out of the mixer.
+    vector<pair<loadgen::types::Type, double>> proportions = {
+        {loadgen::types::Type::READ, config.read_proportion},
+        {loadgen::types::Type::UPDATE, config.update_proportion},
+        {loadgen::types::Type::WRITE, config.insert_proportion},
+        {loadgen::types::Type::SCAN, config.scan_proportion},
+        {loadgen::types::Type::DEL, config.delete_proportion},
+        {loadgen::types::Type::READ_MODIFY_WRITE,
+         config.read_modify_write_proportion},
+        {loadgen::types::Type::MULTI_GET, config.multi_get_proportion}};
+    OperationMixer::Method mixer_method;
+    if (config.operation_mixer == "CUMULATIVE") {
+        mixer_method = OperationMixer::Method::CUMULATIVE;
+    } else if (config.operation_mixer == "ALIAS") {
+        mixer_method = OperationMixer::Method::ALIAS;
+    } else {
+        throw invalid_argument("Unknown operation_mixer: " +
+                               config.operation_mixer);
+    }
+
+    if (config.multi_get_proportion > 0) {
+        if (config.min_multi_get_size < 1 ||
+            config.max_multi_get_size < config.min_multi_get_size) {
+            throw invalid_argument(
+                "multi_get sizes must satisfy 1 <= min <= max");
+        }
+        if (config.multi_get_size_distribution != "UNIFORM" &&
+            config.multi_get_size_distribution != "ZIPFIAN") {
+            throw invalid_argument("Unknown multi_get_size_distribution: " +
+                                   config.multi_get_size_distribution);
+        }
+    }
+    return OperationMixer(proportions, mixer_method);
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Arrivals
+// ────────────────────────────────────────────────────────────────────────
+// TOML distinguishes `rate = 1000` from `rate = 1000.0`; accept both.
+static double as_number(const toml::value &value) {
+    return value.is_integer() ? static_cast<double>(value.as_integer())
+                              : value.as_floating();
+}
+
+static double find_number(const toml::value &config, const char *key,
+                          double fallback) {
+    const toml::value &workload = toml::find(config, "workload");
+    return workload.contains(key) ? as_number(workload.at(key)) : fallback;
+}
+
+// `workload.arrival_curve = [[start_s, rate], ...]`.
+static vector<pair<double, double>>
+load_arrival_curve(const toml::value &config) {
+    vector<pair<double, double>> curve;
+    if (!toml::find(config, "workload").contains("arrival_curve")) {
+        return curve;
+    }
+    const auto &points =
+        toml::find<toml::array>(config, "workload", "arrival_curve");
+    for (size_t i = 0; i < points.size(); i++) {
+        const toml::array &point = points[i].as_array();
+        if (point.size() != 2) {
+            throw invalid_argument(
+                "arrival_curve points are [start second, rate] pairs");
+        }
+        curve.push_back(make_pair(as_number(point[0]), as_number(point[1])));
+    }
+    return curve;
+}
+
 // ────────────────────────────────────────────────────────────────────────
 // Public helpers
 // ────────────────────────────────────────────────────────────────────────
@@ -87,6 +288,10 @@ void RequestGenerator::load_config(const std::string &config_path) {
     n_requests_ = 0;
 
     const auto config = toml::parse(config_path);
+    // With phases, the settings phases can override are optional at the top
+    // level and n_operations is their total.
+    const bool has_phases =
+        toml::find(config, "workload").contains("phases");
 
     config_.export_path =
         toml::find<string>(config, "output", "requests", "export_path");
@@ -98,18 +303,33 @@ void RequestGenerator::load_config(const std::string &config_path) {
     config_.key_seed = toml::find<long>(config, "workload", "key_seed");
     config_.operation_seed =
         toml::find<long>(config, "workload", "operation_seed");
-    config_.n_records = toml::find<int>(config, "workload", "n_records");
-    config_.n_operations = toml::find<int>(config, "workload", "n_operations");
-    config_.data_distribution =
-        toml::find<string>(config, "workload", "data_distribution");
-    config_.read_proportion =
-        toml::find<double>(config, "workload", "read_proportion");
-    config_.update_proportion =
-        toml::find<double>(config, "workload", "update_proportion");
-    config_.insert_proportion =
-        toml::find<double>(config, "workload", "insert_proportion");
-    config_.scan_proportion =
-        toml::find<double>(config, "workload", "scan_proportion");
+    config_.n_records = toml::find<long>(config, "workload", "n_records");
+    if (has_phases) {
+        config_.n_operations = 0;
+        config_.data_distribution = toml::find_or<string>(
+            config, "workload", "data_distribution", "UNIFORM");
+        config_.read_proportion =
+            toml::find_or<double>(config, "workload", "read_proportion", 0.0);
+        config_.update_proportion = toml::find_or<double>(
+            config, "workload", "update_proportion", 0.0);
+        config_.insert_proportion = toml::find_or<double>(
+            config, "workload", "insert_proportion", 0.0);
+        config_.scan_proportion =
+            toml::find_or<double>(config, "workload", "scan_proportion", 0.0);
+    } else {
+        config_.n_operations =
+            toml::find<long>(config, "workload", "n_operations");
+        config_.data_distribution =
+            toml::find<string>(config, "workload", "data_distribution");
+        config_.read_proportion =
+            toml::find<double>(config, "workload", "read_proportion");
+        config_.update_proportion =
+            toml::find<double>(config, "workload", "update_proportion");
+        config_.insert_proportion =
+            toml::find<double>(config, "workload", "insert_proportion");
+        config_.scan_proportion =
+            toml::find<double>(config, "workload", "scan_proportion");
+    }
 
     config_.scan_seed = 0;
     config_.scan_length_distribution = "UNIFORM";
@@ -121,10 +341,122 @@ void RequestGenerator::load_config(const std::string &config_path) {
         config_.scan_length_distribution =
             toml::find<string>(config, "workload", "scan_length_distribution");
         config_.min_scan_length =
-            toml::find<int>(config, "workload", "min_scan_length");
+            toml::find<long>(config, "workload", "min_scan_length");
         config_.max_scan_length =
-            toml::find<int>(config, "workload", "max_scan_length");
+            toml::find<long>(config, "workload", "max_scan_length");
+    } else if (has_phases) {
+        config_.scan_seed =
+            toml::find_or<long>(config, "workload", "scan_seed", 0L);
+        config_.scan_length_distribution = toml::find_or<string>(
+            config, "workload", "scan_length_distribution", "UNIFORM");
+        config_.min_scan_length =
+            toml::find_or<long>(config, "workload", "min_scan_length", 1L);
+        config_.max_scan_length =
+            toml::find_or<long>(config, "workload", "max_scan_length", 1000L);
+    }
+
+    config_.delete_proportion =
+        toml::find_or<double>(config, "workload", "delete_proportion", 0.0);
+    config_.read_modify_write_proportion = toml::find_or<double>(
+        config, "workload", "read_modify_write_proportion", 0.0);
+    config_.multi_get_proportion = toml::find_or<double>(
+        config, "workload", "multi_get_proportion", 0.0);
+    config_.multi_get_seed =
+        toml::find_or<long>(config, "workload", "multi_get_seed", 0L);
+    config_.multi_get_size_distribution = toml::find_or<string>(
+        config, "workload", "multi_get_size_distribution", "UNIFORM");
+    config_.min_multi_get_size =
+        toml::find_or<long>(config, "workload", "min_multi_get_size", 1L);
+    config_.max_multi_get_size =
+        toml::find_or<long>(config, "workload", "max_multi_get_size", 10L);
+    config_.operation_mixer = toml::find_or<string>(
+        config, "workload", "operation_mixer", "CUMULATIVE");
+
+    config_.rng_mode =
+        toml::find_or<string>(config, "workload", "rng_mode", "SEQUENTIAL");
+    config_.rng_engine =
+        toml::find_or<string>(config, "workload", "rng_engine", "MT19937");
+    config_.value_seed =
+        toml::find_or<long>(config, "workload", "value_seed",
+                            static_cast<long>(std::mt19937::default_seed));
+    config_.zipfian_zeta =
+        toml::find_or<string>(config, "workload", "zipfian_zeta", "EXACT");
+    config_.key_sampling = toml::find_or<string>(config, "workload",
+                                                 "key_sampling", "REJECTION");
+    config_.hotspot_drift =
+        toml::find_or<string>(config, "workload", "hotspot_drift", "NONE");
+    config_.hotspot_drift_interval = toml::find_or<long>(
+        config, "workload", "hotspot_drift_interval", 100000L);
+    config_.hotspot_drift_step = toml::find_or<long>(
+        config, "workload", "hotspot_drift_step", 1000L);
+    config_.zipfian_scramble =
+        toml::find_or<string>(config, "workload", "zipfian_scramble", "FNV");
+    config_.insert_order =
+        toml::find_or<string>(config, "workload", "insert_order", "ORDERED");
+    config_.key_encoding =
+        toml::find_or<string>(config, "workload", "key_encoding", "DECIMAL");
+    config_.key_width =
+        toml::find_or<long>(config, "workload", "key_width", 0L);
+    config_.key_size_distribution = toml::find_or<string>(
+        config, "workload", "key_size_distribution", "UNIFORM");
+    config_.key_min_size =
+        toml::find_or<long>(config, "workload", "key_min_size", 16L);
+    config_.key_max_size =
+        toml::find_or<long>(config, "workload", "key_max_size", 64L);
+    config_.arrival =
+        toml::find_or<string>(config, "workload", "arrival", "NONE");
+    config_.arrival_rate = find_number(config, "arrival_rate", 0);
+    config_.arrival_seed =
+        toml::find_or<long>(config, "workload", "arrival_seed", 0L);
+    config_.arrival_on_ms =
+        toml::find_or<long>(config, "workload", "arrival_on_ms", 1000L);
+    config_.arrival_off_ms =
+        toml::find_or<long>(config, "workload", "arrival_off_ms", 1000L);
+    config_.arrival_curve = load_arrival_curve(config);
+    config_.ack_window =
+        toml::find_or<long>(config, "workload", "ack_window", 1L << 20);
+    config_.value_generator = toml::find_or<string>(
+        config, "workload", "value_generator", "RANDOM");
+    config_.value_pool_size = toml::find_or<long>(
+        config, "workload", "value_pool_size", 16L << 20);
+    config_.value_compression_ratio = toml::find_or<double>(
+        config, "workload", "value_compression_ratio", 1.0);
+    config_.threads = toml::find_or<int>(config, "output", "requests",
+                                         "threads", 1);
+    config_.chunk_size = toml::find_or<long>(config, "output", "requests",
+                                             "chunk_size", 65536L);
+
+    config_.phases.clear();
+    bool deletes = config_.delete_proportion > 0;
+    if (has_phases) {
+        const auto &tables = toml::find<toml::array>(config, "workload",
+                                                     "phases");
+        for (size_t i = 0; i < tables.size(); i++) {
+            config_.phases.push_back(load_phase(tables[i], config_, i));
+            config_.n_operations += config_.phases.back().n_operations;
+            deletes = deletes || config_.phases.back().delete_proportion > 0;
+        }
     }
+    // Derived from the workload alone, so that the trace does not depend on
+    // the thread count; workloads tracking deletes are generated serially.
+    config_.live_keys =
+        toml::find_or<bool>(config, "workload", "live_keys", deletes);
+    config_.export_format =
+        toml::find_or<string>(config, "output", "requests", "format", "CSV");
+    config_.block_size = toml::find_or<long>(config, "output", "requests",
+                                             "block_size", 4096L);
+    config_.background_writer = toml::find_or<bool>(
+        config, "output", "requests", "background_writer", true);
+    config_.buffer_size = toml::find_or<long>(config, "output", "requests",
+                                              "buffer_size", 4L << 20);
+    config_.direct_io = toml::find_or<bool>(config, "output", "requests",
+                                            "direct_io", false);
+    config_.metrics_path =
+        toml::find_or<string>(config, "output", "metrics", "path", "");
+    config_.metrics_format =
+        toml::find_or<string>(config, "output", "metrics", "format", "JSON");
+    config_.metrics_interval_ms = toml::find_or<long>(
+        config, "output", "metrics", "interval_ms", 1000L);
 }
 
 void RequestGenerator::initialize() {
@@ -143,6 +475,13 @@ const RequestGenerator::Configuration &RequestGenerator::config() const {
 
 bool RequestGenerator::is_initialized() const { return initialized_; }
 
+const GeneratorMetrics &RequestGenerator::metrics() const {
+    if (!metrics_) {
+        throw invalid_argument("metrics() needs an initialized generator");
+    }
+    return *metrics_;
+}
+
 // ────────────────────────────────────────────────────────────────────────
 // Destructor
 // ────────────────────────────────────────────────────────────────────────
@@ -151,68 +490,148 @@ RequestGenerator::~RequestGenerator() { delete insert_key_sequence_; }
 // ────────────────────────────────────────────────────────────────────────
 // Shared initialisation (called from both constructors)
 // ────────────────────────────────────────────────────────────────────────
+/// Largest LATEST key space whose EXACT zeta is summed at setup, about 0.2 s
+/// of pow() calls; larger ones are approximated in constant time.
+static const long EXACT_ZETA_ITEMS = 10000000L;
+
 void RequestGenerator::init() {
-    operation_proportions_.clear();
+    if (config_.ack_window <= 0) {
+        throw invalid_argument("ack_window must be positive");
+    }
+    insert_key_sequence_ = new acknowledged_counter<long>(
+        config_.n_records, static_cast<size_t>(config_.ack_window));
+
+    operation_mixer_ = make_operation_mixer(config_);
 
-    insert_key_sequence_ = new acknowledged_counter<long>(config_.n_records);
+    // Phases cover consecutive operation indices; without phases, a single
+    // one covers them all with the top-level settings.
+    phases_.clear();
+    if (config_.phases.empty()) {
+        OperationPhase phase;
+        phase.config = config_;
+        phase.mixer = operation_mixer_;
+        phase.end = config_.n_operations;
+        phases_.push_back(phase);
+    } else {
+        long begin = 0;
+        for (size_t i = 0; i < config_.phases.size(); i++) {
+            const PhaseConfiguration &settings = config_.phases[i];
+            if (settings.n_operations < 0 || settings.duration_ms < 0) {
+                throw invalid_argument(
+                    "Phase operations and durations must be non-negative");
+            }
+            OperationPhase phase;
+            phase.config = apply_phase(config_, settings, i);
+            phase.mixer = make_operation_mixer(phase.config);
+            phase.begin = begin;
+            phase.end = begin + settings.n_operations;
+            phase.duration_ms = settings.duration_ms;
+            phases_.push_back(phase);
+            begin = phase.end;
+        }
+        config_.n_operations = begin;
+    }
+
+    if (config_.rng_mode == "SEQUENTIAL") {
+        counter_mode_ = false;
+    } else if (config_.rng_mode == "COUNTER") {
+        counter_mode_ = true;
+    } else {
+        throw invalid_argument("Unknown rng_mode: " + config_.rng_mode);
+    }
 
-    if (config_.read_proportion > 0) {
-        operation_proportions_.push_back(
-            make_pair(loadgen::types::Type::READ, config_.read_proportion));
+    if (config_.key_sampling != "REJECTION" &&
+        config_.key_sampling != "BOUNDED") {
+        throw invalid_argument("Unknown key_sampling: " +
+                               config_.key_sampling);
     }
-    if (config_.update_proportion > 0) {
-        operation_proportions_.push_back(
-            make_pair(loadgen::types::Type::UPDATE, config_.update_proportion));
+
+    if (config_.hotspot_drift != "NONE" && config_.hotspot_drift != "ROTATE" &&
+        config_.hotspot_drift != "EPOCH") {
+        throw invalid_argument("Unknown hotspot_drift: " +
+                               config_.hotspot_drift);
     }
-    if (config_.insert_proportion > 0) {
-        operation_proportions_.push_back(
-            make_pair(loadgen::types::Type::WRITE, config_.insert_proportion));
+    if (config_.hotspot_drift != "NONE" &&
+        config_.hotspot_drift_interval <= 0) {
+        throw invalid_argument("hotspot_drift_interval must be positive");
     }
 
-    Distribution data_distribution = str_to_dist(config_.data_distribution);
+    if (config_.zipfian_scramble != "FNV" &&
+        config_.zipfian_scramble != "PERMUTATION") {
+        throw invalid_argument("Unknown zipfian_scramble: " +
+                               config_.zipfian_scramble);
+    }
+    key_encoder_.reset(new KeyEncoder(config_));
+    key_buffer_.resize(KeyEncoder::MAX_SIZE);
 
-    if (data_distribution == UNIFORM) {
-        data_generator_ =
-            uniform_distribution_rand(0, config_.n_records, config_.key_seed);
-    } else if (data_distribution == ZIPFIAN) {
-        int expectednewkeys =
-            (int)((config_.n_operations) * config_.insert_proportion * 2.0);
-        data_generator_ = scrambled_zipfian_distribution(
-            0, config_.n_records + expectednewkeys, config_.key_seed);
-    } else if (data_distribution == LATEST) {
-        zipfian_int_distribution<long> *zip =
-            new zipfian_int_distribution<long>(
-                0, insert_key_sequence_->last_value());
-        data_generator_ = skewed_latest_distribution(insert_key_sequence_, zip,
-                                                     config_.key_seed);
-        // leaking
+    insert_order_.reset();
+    if (config_.insert_order == "HASHED") {
+        // Every insert the workload can make; later keys stay in order.
+        insert_order_.reset(new feistel_permutation(
+            static_cast<uint64_t>(config_.n_records + config_.n_operations),
+            counter_engine::mix(static_cast<uint64_t>(config_.key_seed))));
+    } else if (config_.insert_order != "ORDERED") {
+        throw invalid_argument("Unknown insert_order: " +
+                               config_.insert_order);
     }
 
-    if (config_.scan_proportion > 0) {
-        operation_proportions_.push_back(
-            make_pair(loadgen::types::Type::SCAN, config_.scan_proportion));
+    ZetaMode zeta_mode;
+    if (config_.zipfian_zeta == "EXACT") {
+        zeta_mode = ZetaMode::EXACT;
+    } else if (config_.zipfian_zeta == "APPROXIMATE") {
+        zeta_mode = ZetaMode::APPROXIMATE;
+    } else {
+        throw invalid_argument("Unknown zipfian_zeta: " +
+                               config_.zipfian_zeta);
+    }
 
-        Distribution scan_len_dist =
-            str_to_dist(config_.scan_length_distribution);
-        if (scan_len_dist == UNIFORM) {
-            scan_length_generator_ = uniform_distribution_rand(
-                config_.min_scan_length, config_.max_scan_length,
-                config_.scan_seed);
-        } else if (scan_len_dist == ZIPFIAN) {
-            scan_length_generator_ = scrambled_zipfian_distribution(
-                0, config_.n_records, config_.scan_seed);
+    bool latest = str_to_dist(config_.data_distribution) == LATEST;
+    bool gen_values = config_.gen_values;
+    long value_max_size = config_.value_max_size;
+    for (size_t i = 0; i < phases_.size(); i++) {
+        const Configuration &phase = phases_[i].config;
+        latest = latest || str_to_dist(phase.data_distribution) == LATEST;
+        gen_values = gen_values || phase.gen_values;
+        value_max_size = max(value_max_size, phase.value_max_size);
+    }
+    if (latest) {
+        long items = insert_key_sequence_->last_value() + 1;
+        if (items > EXACT_ZETA_ITEMS) {
+            zeta_mode = ZetaMode::APPROXIMATE;
         }
+        latest_zipfian_ = zipfian_int_distribution<long>(
+            0, insert_key_sequence_->last_value(), zeta_mode);
     }
 
-    operation_generator_ =
-        uniform_double_distribution_rand(0.0, 1.0, config_.operation_seed);
-
-    if (config_.gen_values) {
-        char_generator_ = CharGenerator();
-        len_generator_ = uniform_distribution_rand(config_.value_min_size,
-                                                   config_.value_max_size);
+    value_pool_.reset();
+    if (config_.value_generator == "POOL") {
+        if (gen_values) {
+            value_pool_.reset(new ValuePool(
+                static_cast<size_t>(config_.value_pool_size),
+                static_cast<size_t>(max(value_max_size, 0L)),
+                config_.value_compression_ratio,
+                static_cast<uint64_t>(config_.value_seed)));
+        }
+    } else if (config_.value_generator != "RANDOM" &&
+               config_.value_generator != "DERIVED") {
+        throw invalid_argument("Unknown value_generator: " +
+                               config_.value_generator);
     }
 
+    metrics_.reset(new GeneratorMetrics());
+    counters_ = metrics_->add_shard();
+    live_keys_.reset(config_.live_keys ? new LiveKeySet() : nullptr);
+    arrivals_.reset(config_.arrival != "NONE" ? new ArrivalProcess(config_)
+                                              : nullptr);
+    arrival_sum_ = 0;
+    arrival_ns_ = 0;
+    make_pipelines(pipeline_, phase_pipelines_);
+    operations_pipeline_ = phase_pipelines_.empty()
+                               ? pipeline_.get()
+                               : phase_pipelines_[0].get();
+    phase_index_ = 0;
+    phase_entered_ = false;
+
     phase_ = Phase::LOADING;
     loading_index_ = 0;
     operations_index_ = 0;
@@ -220,16 +639,20 @@ void RequestGenerator::init() {
 }
 
 loadgen::types::Type RequestGenerator::next_operation(
-    std::vector<std::pair<loadgen::types::Type, double>> values,
+    const std::vector<std::pair<loadgen::types::Type, double>> &values,
     rfunc::DoubleRandFunction *generator) {
+    return select_operation(values, (*generator)());
+}
+
+loadgen::types::Type RequestGenerator::select_operation(
+    const std::vector<std::pair<loadgen::types::Type, double>> &values,
+    double val) {
     double sum = 0;
 
     for (size_t i = 0; i < values.size(); i++) {
         sum += values[i].second;
     }
 
-    double val = (*generator)();
-
     for (size_t i = 0; i < values.size(); i++) {
         double vw = values[i].second / sum;
         if (val < vw) {
@@ -250,38 +673,138 @@ void RequestGenerator::skip_current_phase() {
     if (phase_ == Phase::LOADING) {
         phase_ = Phase::OPERATIONS;
     } else if (phase_ == Phase::OPERATIONS) {
-        phase_ = Phase::DONE;
+        if (phase_index_ + 1 < phases_.size()) {
+            operations_index_ = phases_[phase_index_].end;
+            phase_index_++;
+            phase_entered_ = false;
+        } else {
+            phase_ = Phase::DONE;
+        }
+    }
+    if (counters_ != nullptr) {
+        counters_->enter_phase(phase_);
     }
 }
 
 // ────────────────────────────────────────────────────────────────────────
 // next()  –  returns true when the workload has ended
 // ────────────────────────────────────────────────────────────────────────
+std::unique_ptr<RequestPipeline> RequestGenerator::make_pipeline(
+    const Configuration &config, const OperationMixer &mixer,
+    acknowledged_counter<long> *counter, LiveKeySet *live_keys,
+    const zipfian_int_distribution<long> &latest_zipfian,
+    GeneratorCounters *counters) const {
+    return make_request_pipeline(config, mixer, counter, live_keys,
+                                 latest_zipfian, value_pool_.get(),
+                                 insert_order_.get(), StreamInserts(),
+                                 counters);
+}
+
+void RequestGenerator::make_pipelines(
+    std::unique_ptr<RequestPipeline> &pipeline,
+    std::vector<std::unique_ptr<RequestPipeline>> &phase_pipelines) const {
+    pipeline = make_pipeline(config_, operation_mixer_, insert_key_sequence_,
+                             live_keys_.get(), latest_zipfian_, counters_);
+    phase_pipelines.clear();
+    if (!config_.phases.empty()) {
+        for (size_t i = 0; i < phases_.size(); i++) {
+            phase_pipelines.push_back(make_pipeline(
+                phases_[i].config, phases_[i].mixer, insert_key_sequence_,
+                live_keys_.get(), latest_zipfian_, counters_));
+        }
+    }
+}
+
+size_t RequestGenerator::phase_of(long index) const {
+    size_t lo = 0, hi = phases_.size() - 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (phases_[mid].end <= index) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool RequestGenerator::enter_operation_phase() {
+    while (true) {
+        const OperationPhase &phase = phases_[phase_index_];
+        if (!phase_entered_) {
+            phase_entered_ = true;
+            operations_index_ = max(operations_index_, phase.begin);
+            operations_pipeline_ = phase_pipelines_.empty()
+                                       ? pipeline_.get()
+                                       : phase_pipelines_[phase_index_].get();
+            if (phase.duration_ms > 0) {
+                phase_deadline_ = chrono::steady_clock::now() +
+                                  chrono::milliseconds(phase.duration_ms);
+            }
+        }
+        if (operations_index_ < phase.end &&
+            (phase.duration_ms == 0 ||
+             chrono::steady_clock::now() < phase_deadline_)) {
+            return true;
+        }
+        // Operations left when the time ran out are skipped, so the indices
+        // and value versions of the next phases stay the same.
+        operations_index_ = phase.end;
+        if (phase_index_ + 1 == phases_.size()) {
+            return false;
+        }
+        phase_index_++;
+        phase_entered_ = false;
+    }
+}
+
+uint64_t RequestGenerator::next_arrival(long index) {
+    if (!arrivals_) {
+        return 0;
+    }
+    arrival_ns_ = arrivals_->time_ns(arrival_sum_);
+    arrival_sum_ += arrivals_->gap(index);
+    return arrival_ns_;
+}
+
+const std::vector<long> &RequestGenerator::multi_get_keys() const {
+    if (!pipeline_) {
+        throw invalid_argument(
+            "multi_get_keys() needs an initialized generator");
+    }
+    return operations_pipeline_->multi_get_keys();
+}
+
 RequestGenerator::Phase RequestGenerator::next(loadgen::types::Type &type,
                                                long &key, std::string &value,
                                                long &scan_size) {
-    value.clear();
+    ByteView view;
+    Phase phase = next(type, key, view, scan_size);
+    value.assign(view.data, view.size);
+    return phase;
+}
+
+RequestGenerator::Phase RequestGenerator::next(loadgen::types::Type &type,
+                                               long &key, ByteView &value,
+                                               long &scan_size) {
+    value = ByteView();
     scan_size = 0;
 
     if (phase_ == Phase::DONE) {
         return phase_;
     }
+    counters_->enter_phase(phase_);
 
     // ── Loading phase: emit initial records (WRITE keys 0 … n_records-1) ──
     if (phase_ == Phase::LOADING) {
         if (loading_index_ < config_.n_records) {
             type = loadgen::types::Type::WRITE;
-            key = loading_index_;
+            key = insert_key(insert_order_.get(), loading_index_);
 
             if (config_.gen_values) {
-                char buf[MAX_VALUE_LEN + 1];
-                long length = len_generator_();
-                for (long i = 0; i < length; i++) {
-                    buf[i] = char_generator_();
-                }
-                buf[length] = '\0';
-                value.assign(buf, static_cast<size_t>(length));
+                pipeline_->loading_value(loading_index_, value);
             }
+            counters_->add(GeneratorCounters::LOADED, 1);
 
             loading_index_++;
 
@@ -289,123 +812,721 @@ RequestGenerator::Phase RequestGenerator::next(loadgen::types::Type &type,
         }
         // Loading finished → move to operations
         phase_ = Phase::OPERATIONS;
+        counters_->enter_phase(phase_);
     }
 
     // ── Operations phase ──────────────────────────────────────────────
     if (phase_ == Phase::OPERATIONS) {
-        if (operations_index_ < config_.n_operations) {
-            type =
-                next_operation(operation_proportions_, &operation_generator_);
-
-            if (type == loadgen::types::Type::READ ||
-                type == loadgen::types::Type::UPDATE) {
-                do {
-                    key = data_generator_();
-                } while (key >= insert_key_sequence_->last_value());
-
-                if (type == loadgen::types::Type::UPDATE) {
-                    type = loadgen::types::Type::WRITE;
-                }
-            } else if (type == loadgen::types::Type::SCAN) {
-                long size = scan_length_generator_();
-                scan_size = size;
-                n_requests_ += (size - 1);
-                do {
-                    key = data_generator_();
-                } while (key + size >= insert_key_sequence_->last_value());
-            } else if (type == loadgen::types::Type::WRITE) {
-                key = insert_key_sequence_->next();
-            }
-
-            // Generate a value for WRITE operations when gen_values is on
-            if (type == loadgen::types::Type::WRITE && config_.gen_values) {
-                char buf[MAX_VALUE_LEN + 1];
-                long length = len_generator_();
-                for (long i = 0; i < length; i++) {
-                    buf[i] = char_generator_();
-                }
-                buf[length] = '\0';
-                value.assign(buf, static_cast<size_t>(length));
-            }
-
+        if (enter_operation_phase()) {
+            n_requests_ += operations_pipeline_->operation(
+                operations_index_, type, key, value, scan_size);
+            next_arrival(operations_index_);
             operations_index_++;
             return phase_;
         }
 
         phase_ = Phase::DONE;
+        counters_->enter_phase(phase_);
     }
 
     return phase_; // workload ended
 }
 
+// ────────────────────────────────────────────────────────────────────────
+// next_batch()  –  fill a structure-of-arrays batch
+// ────────────────────────────────────────────────────────────────────────
+size_t RequestGenerator::next_batch(size_t n, RequestBatch &batch,
+                                    bool acknowledge_writes) {
+    batch.resize(n);
+
+    size_t count = 0;
+    ByteView value;
+    while (count < n && phase_ != Phase::DONE) {
+        counters_->enter_phase(phase_);
+        if (phase_ == Phase::LOADING) {
+            if (loading_index_ >= config_.n_records) {
+                phase_ = Phase::OPERATIONS;
+                continue;
+            }
+            long end = min(loading_index_ + static_cast<long>(n - count),
+                           config_.n_records);
+            for (long i = loading_index_; i < end; i++, count++) {
+                size_t offset = batch.values.size();
+                if (config_.gen_values) {
+                    pipeline_->loading_value(i, value);
+                    batch.values.append(value.data, value.size);
+                }
+                batch.phases[count] = Phase::LOADING;
+                batch.phase_indices[count] = 0;
+                batch.arrival_times[count] = 0;
+                batch.types[count] = loadgen::types::Type::WRITE;
+                batch.keys[count] = insert_key(insert_order_.get(), i);
+                batch.scan_sizes[count] = 0;
+                batch.value_offsets[count] = offset;
+                batch.value_lengths[count] = batch.values.size() - offset;
+                batch.value_versions[count] = static_cast<uint64_t>(i);
+                batch.key_offsets[count] = batch.multi_get_keys.size();
+            }
+            counters_->add(GeneratorCounters::LOADED, end - loading_index_);
+            loading_index_ = end;
+        } else {
+            if (!enter_operation_phase()) {
+                phase_ = Phase::DONE;
+                counters_->enter_phase(phase_);
+                continue;
+            }
+            long end = min(operations_index_ + static_cast<long>(n - count),
+                           phases_[phase_index_].end);
+            for (long i = operations_index_; i < end; i++, count++) {
+                size_t offset = batch.values.size();
+                n_requests_ += operations_pipeline_->operation(
+                    i, batch.types[count], batch.keys[count], value,
+                    batch.scan_sizes[count]);
+                batch.values.append(value.data, value.size);
+                batch.phases[count] = Phase::OPERATIONS;
+                batch.phase_indices[count] = phase_index_;
+                batch.arrival_times[count] = next_arrival(i);
+                batch.value_offsets[count] = offset;
+                batch.value_lengths[count] = batch.values.size() - offset;
+                batch.value_versions[count] =
+                    static_cast<uint64_t>(config_.n_records + i);
+                append_multi_get_keys(*operations_pipeline_, batch, count);
+                if (acknowledge_writes &&
+                    batch.types[count] == loadgen::types::Type::WRITE) {
+                    acknowledge(batch.keys[count]);
+                }
+            }
+            operations_index_ = end;
+        }
+    }
+
+    batch.count = count;
+    return count;
+}
+
 // ────────────────────────────────────────────────────────────────────────
 // acknowledge()  –  update the atomic acknowledged counter
 // ────────────────────────────────────────────────────────────────────────
 void RequestGenerator::acknowledge(long key) {
-    insert_key_sequence_->acknowledge(key);
+    insert_key_sequence_->acknowledge(insert_index(insert_order_.get(), key));
+}
+
+long RequestGenerator::pending_inserts() const {
+    return insert_key_sequence_->peek() - 1 -
+           insert_key_sequence_->last_value();
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// encode_key()  –  key bytes in the key_encoding
+// ────────────────────────────────────────────────────────────────────────
+ByteView RequestGenerator::encode_key(long key) {
+    return ByteView(key_buffer_.data(),
+                    key_encoder_->encode(key, &key_buffer_[0]));
+}
+
+const KeyEncoder &RequestGenerator::key_encoder() const {
+    return *key_encoder_;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// make_streams()  –  split the workload into per-client streams
+// ────────────────────────────────────────────────────────────────────────
+static long stream_seed(long seed, size_t stream) {
+    if (stream == 0) {
+        return seed;
+    }
+    rfunc::counter_engine engine(static_cast<uint64_t>(seed), stream);
+    return static_cast<long>(engine());
+}
+
+static void derive_stream_seeds(RequestGenerator::Configuration &config,
+                                size_t stream) {
+    config.key_seed = stream_seed(config.key_seed, stream);
+    config.operation_seed = stream_seed(config.operation_seed, stream);
+    config.scan_seed = stream_seed(config.scan_seed, stream);
+    config.multi_get_seed = stream_seed(config.multi_get_seed, stream);
+    if (config.value_generator != "DERIVED") {
+        config.value_seed = stream_seed(config.value_seed, stream);
+    }
+}
+
+std::vector<std::unique_ptr<RequestStream>>
+RequestGenerator::make_streams(size_t n, StreamKeys keys) const {
+    if (!initialized_) {
+        throw invalid_argument("make_streams() needs an initialized generator");
+    }
+    if (n == 0) {
+        throw invalid_argument("make_streams() needs at least one stream");
+    }
+
+    const long n_records = config_.n_records;
+    const long count = static_cast<long>(n);
+
+    vector<unique_ptr<RequestStream>> streams;
+    for (size_t i = 0; i < n; i++) {
+        const long s = static_cast<long>(i);
+        Configuration config = config_;
+        vector<OperationPhase> phases = phases_;
+        // Operations of the streams before this one, which start its RANGES
+        // insert keys.
+        long operations_before = 0;
+        for (size_t p = 0; p < phases.size(); p++) {
+            OperationPhase &phase = phases[p];
+            if (!counter_mode_) {
+                derive_stream_seeds(phase.config, i);
+            }
+            long size = phases_[p].end - phases_[p].begin;
+            phase.begin = phases_[p].begin + size * s / count;
+            phase.end = phases_[p].begin + size * (s + 1) / count;
+            operations_before += size * s / count;
+        }
+        if (!counter_mode_) {
+            derive_stream_seeds(config, i);
+        }
+        // Each stream issues its share of the arrivals.
+        config.arrival_rate /= count;
+        for (size_t p = 0; p < config.arrival_curve.size(); p++) {
+            config.arrival_curve[p].second /= count;
+        }
+
+        long key_start = keys == StreamKeys::INTERLEAVED
+                             ? n_records + s
+                             : n_records + operations_before;
+        long key_stride = keys == StreamKeys::INTERLEAVED ? count : 1;
+
+        streams.push_back(unique_ptr<RequestStream>(new RequestStream(
+            config, operation_mixer_, phases, latest_zipfian_,
+            value_pool_.get(), insert_order_.get(), metrics_->add_shard(),
+            n_records * s / count, n_records * (s + 1) / count, key_start,
+            key_stride)));
+    }
+    return streams;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// checkpoint() / restore() / seek()  –  jump to another point of the workload
+// ────────────────────────────────────────────────────────────────────────
+// A checkpoint is a text line of magic, version and configuration length,
+// the configuration as in binary trace headers (restore() checks it against
+// its own), then the state fields separated by spaces.
+static const char CHECKPOINT_MAGIC[] = "LGCHECKPOINT";
+static const int CHECKPOINT_VERSION = 1;
+
+std::string RequestGenerator::checkpoint() const {
+    if (!pipeline_) {
+        throw invalid_argument("checkpoint() needs an initialized generator");
+    }
+    string configuration;
+    binary_trace::put_configuration(configuration, config_);
+    ostringstream os;
+    os << CHECKPOINT_MAGIC << ' ' << CHECKPOINT_VERSION << ' '
+       << configuration.size() << '\n';
+    os.write(configuration.data(), configuration.size());
+    os << '\n'
+       << static_cast<int>(phase_) << ' ' << loading_index_ << ' '
+       << operations_index_ << ' ' << n_requests_ << ' ' << phase_index_
+       << ' ' << insert_key_sequence_->peek() << ' '
+       << insert_key_sequence_->last_value() << ' ' << arrival_sum_ << ' '
+       << arrival_ns_ << ' ' << (live_keys_ ? 1 : 0);
+    if (live_keys_) {
+        os << ' ' << *live_keys_;
+    }
+    os << ' ';
+    pipeline_->save_state(os);
+    for (size_t i = 0; i < phase_pipelines_.size(); i++) {
+        os << ' ';
+        phase_pipelines_[i]->save_state(os);
+    }
+    os << '\n';
+    return os.str();
+}
+
+void RequestGenerator::restore(const std::string &checkpoint) {
+    if (!pipeline_) {
+        throw invalid_argument("restore() needs an initialized generator");
+    }
+    istringstream is(checkpoint);
+    string magic;
+    int version = 0;
+    size_t length = 0;
+    if (!(is >> magic >> version >> length) || magic != CHECKPOINT_MAGIC ||
+        version != CHECKPOINT_VERSION || is.get() != '\n') {
+        throw invalid_argument("Not a generator checkpoint");
+    }
+    string configuration(length, '\0'), expected;
+    is.read(&configuration[0], static_cast<streamsize>(length));
+    binary_trace::put_configuration(expected, config_);
+    if (!is || configuration != expected) {
+        throw invalid_argument(
+            "The checkpoint was taken with another workload configuration");
+    }
+
+    int phase, live;
+    long loading_index, operations_index, next_key, last_value;
+    long long n_requests;
+    size_t phase_index;
+    uint64_t arrival_sum, arrival_ns;
+    is >> phase >> loading_index >> operations_index >> n_requests >>
+        phase_index >> next_key >> last_value >> arrival_sum >> arrival_ns >>
+        live;
+    unique_ptr<LiveKeySet> live_keys;
+    if (is && live) {
+        live_keys.reset(new LiveKeySet());
+        is >> *live_keys;
+    }
+    unique_ptr<RequestPipeline> pipeline;
+    vector<unique_ptr<RequestPipeline>> phase_pipelines;
+    make_pipelines(pipeline, phase_pipelines);
+    pipeline->load_state(is);
+    for (size_t i = 0; i < phase_pipelines.size(); i++) {
+        phase_pipelines[i]->load_state(is);
+    }
+    if (!is || phase < 0 || phase > static_cast<int>(Phase::DONE) ||
+        phase_index >= phases_.size() || (live != 0) != bool(live_keys_)) {
+        throw invalid_argument("Malformed generator checkpoint");
+    }
+
+    // The pipelines above point at the live keys the generator owns.
+    if (live_keys_) {
+        *live_keys_ = *live_keys;
+    }
+    pipeline_ = move(pipeline);
+    phase_pipelines_ = move(phase_pipelines);
+    operations_pipeline_ = phase_pipelines_.empty()
+                               ? pipeline_.get()
+                               : phase_pipelines_[phase_index].get();
+    insert_key_sequence_->restart(next_key, last_value);
+    phase_ = static_cast<Phase>(phase);
+    loading_index_ = loading_index;
+    operations_index_ = operations_index;
+    n_requests_ = n_requests;
+    phase_index_ = phase_index;
+    phase_entered_ = false;
+    arrival_sum_ = arrival_sum;
+    arrival_ns_ = arrival_ns;
+}
+
+void RequestGenerator::seek(long index) {
+    if (!pipeline_) {
+        throw invalid_argument("seek() needs an initialized generator");
+    }
+    if (!counter_mode_) {
+        throw invalid_argument("seek() requires rng_mode = \"COUNTER\"");
+    }
+    if (live_keys_) {
+        throw invalid_argument("seek() does not support live_keys");
+    }
+    const long n_records = config_.n_records;
+    if (index < 0 || index > n_records + config_.n_operations) {
+        throw invalid_argument("seek() past the end of the workload");
+    }
+    long operation = max(index - n_records, 0L);
+
+    // Fresh pipelines: the LATEST zeta sums of the current ones may already
+    // cover more inserts than the operation follows.
+    unique_ptr<RequestPipeline> pipeline;
+    vector<unique_ptr<RequestPipeline>> phase_pipelines;
+    make_pipelines(pipeline, phase_pipelines);
+    long inserted = 0;
+    for (size_t p = 0; p < phases_.size() && phases_[p].begin < operation;
+         p++) {
+        if (!(phases_[p].config.insert_proportion > 0)) {
+            continue;
+        }
+        RequestPipeline *types = phase_pipelines.empty()
+                                     ? pipeline.get()
+                                     : phase_pipelines[p].get();
+        long end = min(phases_[p].end, operation);
+        for (long i = phases_[p].begin; i < end; i++) {
+            if (types->operation_type(i) == loadgen::types::Type::WRITE) {
+                inserted++;
+            }
+        }
+    }
+    arrival_sum_ = 0;
+    arrival_ns_ = 0;
+    if (arrivals_ && operation > 0) {
+        uint64_t before = arrivals_->gaps(0, operation - 1);
+        arrival_ns_ = arrivals_->time_ns(before);
+        arrival_sum_ = before + arrivals_->gap(operation - 1);
+    }
+
+    pipeline_ = move(pipeline);
+    phase_pipelines_ = move(phase_pipelines);
+    insert_key_sequence_->restart(n_records + inserted);
+    phase_index_ = phase_of(operation);
+    operations_pipeline_ = phase_pipelines_.empty()
+                               ? pipeline_.get()
+                               : phase_pipelines_[phase_index_].get();
+    phase_entered_ = false;
+    phase_ = index < n_records ? Phase::LOADING : Phase::OPERATIONS;
+    loading_index_ = min(index, n_records);
+    operations_index_ = operation;
+    n_requests_ = config_.n_operations;
 }
 
 // ────────────────────────────────────────────────────────────────────────
 // generate_to_file()  –  dump full workload to the export file
 // ────────────────────────────────────────────────────────────────────────
 void RequestGenerator::generate_to_file() {
-    cout << "Generating " << config_.export_path << " ..." << endl;
-    auto progress_thread = thread(export_print_progress, &progress_);
-    generate_to_file(config_.export_path, false);
+    // A trace written to stdout keeps the messages off the data stream.
+    bool to_stdout = config_.export_path == "-";
+    ostream &log = to_stdout ? cerr : cout;
 
+    log << "Generating " << config_.export_path << " ..." << endl;
+    unique_ptr<MetricsReporter> reporter =
+        make_metrics_reporter(*metrics_, config_);
+    atomic<bool> done(false);
+    auto progress_thread =
+        thread(export_print_progress, metrics_.get(),
+               static_cast<double>(config_.n_records) + config_.n_operations,
+               &done, to_stdout ? stderr : stdout);
+    try {
+        generate_to_file(config_.export_path, false);
+    } catch (...) {
+        done = true;
+        progress_thread.join();
+        throw;
+    }
+    done = true;
     progress_thread.join();
+    if (reporter) {
+        reporter->stop();
+    }
 
-    cout << "number of writes/reads to keys: " << n_requests_ << endl;
-    cout << "Generated into " << config_.export_path << endl;
+    log << "number of writes/reads to keys: " << n_requests_ << endl;
+    MetricsSnapshot snapshot = metrics_->snapshot();
+    uint64_t retries = 0;
+    for (int c = GeneratorCounters::READ_RETRIES;
+         c <= GeneratorCounters::MULTI_GET_RETRIES; c++) {
+        retries += snapshot.counters[c];
+    }
+    log << "key draws rejected by the read bounds: " << retries << endl;
+    log << "Generated into " << config_.export_path << endl;
+}
+
+static OutputSink::Options
+sink_options(const RequestGenerator::Configuration &config,
+             GeneratorMetrics &metrics) {
+    OutputSink::Options options;
+    if (config.buffer_size > 0) {
+        options.buffer_size = static_cast<size_t>(config.buffer_size);
+    }
+    options.background = config.background_writer;
+    options.direct_io = config.direct_io;
+    options.written = metrics.output_bytes();
+    return options;
+}
+
+static void
+check_exportable(const RequestGenerator::Configuration &config) {
+    for (size_t i = 0; i < config.phases.size(); i++) {
+        if (config.phases[i].duration_ms > 0) {
+            throw invalid_argument("Phase durations only apply to online "
+                                   "generation; exported traces need "
+                                   "operation counts");
+        }
+    }
 }
 
 void RequestGenerator::generate_to_file(const std::string &filename,
                                         bool skip_loading) {
+    check_exportable(config_);
+    // Deletes change the keys of every later request, so live key tracking
+    // generates in order on this thread, whatever config_.threads says.
+    if (counter_mode_ && !config_.live_keys && phase_ == Phase::LOADING &&
+        loading_index_ == 0) {
+        generate_to_file_parallel(filename, skip_loading);
+        return;
+    }
+    if (config_.threads > 1 && !counter_mode_) {
+        throw invalid_argument(
+            "Parallel generation requires rng_mode = \"COUNTER\"");
+    }
+
+    FdOutputSink sink(filename, sink_options(config_, *metrics_));
+    unique_ptr<TraceWriter> writer = make_trace_writer(config_, sink);
+    if (skip_loading) {
+        skip_loading_records();
+    }
+    write_requests(*writer, numeric_limits<long>::max());
+    writer->finish();
+    sink.close();
+}
 
-    float total = static_cast<float>(config_.n_records + config_.n_operations);
-    progress_ = 0;
+void RequestGenerator::generate_range_to_file(const std::string &filename,
+                                              long begin, long end) {
+    check_exportable(config_);
+    if (end < begin) {
+        throw invalid_argument("generate_range_to_file() needs begin <= end");
+    }
+    seek(begin);
+    FdOutputSink sink(filename, sink_options(config_, *metrics_));
+    unique_ptr<TraceWriter> writer = make_trace_writer(config_, sink);
+    write_requests(*writer, end - begin);
+    writer->finish();
+    sink.close();
+}
 
-    ofstream ofs(filename, ofstream::out);
+void RequestGenerator::skip_loading_records() {
+    if (phase_ != Phase::LOADING) {
+        return;
+    }
+    // SEQUENTIAL values of the operations continue the value streams of the
+    // loading records; every other stream is independent of them.
+    if (config_.gen_values && !counter_mode_) {
+        ByteView value;
+        for (; loading_index_ < config_.n_records; loading_index_++) {
+            pipeline_->loading_value(loading_index_, value);
+        }
+    }
+    loading_index_ = config_.n_records;
+}
 
+void RequestGenerator::write_requests(TraceWriter &writer, long count) {
     loadgen::types::Type type;
     long key;
-    std::string value;
+    ByteView value;
     long scan_size;
-    long count = 0;
 
-    while (true) {
+    for (long n = 0; n < count; n++) {
         Phase phase = next(type, key, value, scan_size);
         if (phase == Phase::DONE) {
             break;
         }
 
-        if (skip_loading && phase == Phase::LOADING) {
-            continue;
+        if (phase == Phase::OPERATIONS) {
+            writer.enter_phase(phase_index_);
+        }
+        uint64_t version =
+            phase == Phase::LOADING
+                ? static_cast<uint64_t>(loading_index_ - 1)
+                : static_cast<uint64_t>(config_.n_records + operations_index_ -
+                                        1);
+        writer.write(phase, type, key, value.data, value.size, scan_size,
+                     version,
+                     type == loadgen::types::Type::MULTI_GET
+                         ? operations_pipeline_->multi_get_keys().data()
+                         : nullptr,
+                     phase == Phase::OPERATIONS ? arrival_ns_ : 0);
+        if (type == loadgen::types::Type::WRITE) {
+            acknowledge(key);
         }
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// generate_to_file_parallel()  –  chunked generation in COUNTER mode
+// ────────────────────────────────────────────────────────────────────────
+// Every request only depends on its index, except for the insert keys and
+// the LATEST bound, which depend on how many inserts precede it. Each round
+// therefore first counts the inserts of its chunks (operation types are drawn
+// from their own stream), turns the counts into per-chunk starting points and
+// then generates the chunks, which are written back in order.
+void RequestGenerator::generate_to_file_parallel(const std::string &filename,
+                                                 bool skip_loading) {
+    const long n_records = config_.n_records;
+    const long n_operations = config_.n_operations;
+    const long chunk_size = config_.chunk_size > 0 ? config_.chunk_size : 1;
+    const size_t n_threads =
+        static_cast<size_t>(config_.threads > 0 ? config_.threads : 1);
+
+    // One shard per worker slot; the workers of a slot run one at a time.
+    vector<GeneratorCounters *> shards(n_threads);
+    for (size_t t = 0; t < n_threads; t++) {
+        shards[t] = metrics_->add_shard();
+    }
 
-        if (type == loadgen::types::Type::READ) {
-            ofs << static_cast<int>(type) << "," << setfill('0') << setw(10)
-                << key << endl;
-        } else if (type == loadgen::types::Type::WRITE) {
-            ofs << static_cast<int>(type) << "," << setfill('0') << setw(10)
-                << key;
-            if (!value.empty()) {
-                ofs << "," << value;
+    FdOutputSink sink(filename, sink_options(config_, *metrics_));
+    unique_ptr<TraceWriter> writer = make_trace_writer(config_, sink);
+    vector<RequestBatch> buffers(n_threads);
+    vector<thread> workers;
+
+    if (!skip_loading) {
+        counters_->enter_phase(Phase::LOADING);
+        for (long round = 0; round < n_records;
+             round += chunk_size * n_threads) {
+            for (size_t t = 0; t < n_threads; t++) {
+                long begin = round + chunk_size * t;
+                long end = min(begin + chunk_size, n_records);
+                workers.push_back(thread([this, begin, end, t, &buffers,
+                                          &shards]() {
+                    unique_ptr<RequestPipeline> pipeline = make_pipeline(
+                        config_, operation_mixer_, insert_key_sequence_,
+                        nullptr, latest_zipfian_, shards[t]);
+                    RequestBatch &batch = buffers[t];
+                    batch.resize(end > begin ? end - begin : 0);
+                    ByteView value;
+                    for (long i = begin; i < end; i++) {
+                        size_t j = i - begin;
+                        size_t offset = batch.values.size();
+                        if (config_.gen_values) {
+                            pipeline->loading_value(i, value);
+                            batch.values.append(value.data, value.size);
+                        }
+                        batch.phases[j] = Phase::LOADING;
+                        batch.phase_indices[j] = 0;
+                        batch.arrival_times[j] = 0;
+                        batch.types[j] = loadgen::types::Type::WRITE;
+                        batch.keys[j] = insert_key(insert_order_.get(), i);
+                        batch.scan_sizes[j] = 0;
+                        batch.value_offsets[j] = offset;
+                        batch.value_lengths[j] = batch.values.size() - offset;
+                        batch.value_versions[j] = static_cast<uint64_t>(i);
+                        batch.key_offsets[j] = batch.multi_get_keys.size();
+                    }
+                    batch.count = batch.keys.size();
+                    shards[t]->add(GeneratorCounters::LOADED, batch.count);
+                }));
             }
-            ofs << endl;
-            acknowledge(key);
-        } else if (type == loadgen::types::Type::SCAN) {
-            ofs << static_cast<int>(type) << "," << setfill('0') << setw(10)
-                << key << "," << scan_size << endl;
+            for (size_t t = 0; t < n_threads; t++) {
+                workers[t].join();
+                writer->write_batch(buffers[t]);
+            }
+            workers.clear();
         }
+    }
+    counters_->enter_phase(Phase::OPERATIONS);
+
+    bool latest = false;
+    for (size_t p = 0; p < phases_.size(); p++) {
+        latest = latest ||
+                 str_to_dist(phases_[p].config.data_distribution) == LATEST;
+    }
+    zipfian_int_distribution<long> latest_zipfian = latest_zipfian_;
+    long inserted = 0;
+    long long extra_requests = 0;
+    vector<long> inserts(n_threads);
+    vector<long long> extras(n_threads);
+    // Arrival gaps of the operations so far and of each chunk, which start
+    // the arrival times of the next chunks like the inserts do for keys.
+    const ArrivalProcess *arrivals = arrivals_.get();
+    uint64_t arrived = 0;
+    vector<uint64_t> gaps(n_threads);
+
+    for (long round = 0; round < n_operations;
+         round += chunk_size * n_threads) {
+        for (size_t t = 0; t < n_threads; t++) {
+            long begin = round + chunk_size * t;
+            long end = min(begin + chunk_size, n_operations);
+            workers.push_back(thread([this, begin, end, t, arrivals,
+                                      &inserts, &gaps]() {
+                // Only draws operation types, which are not counted.
+                vector<unique_ptr<RequestPipeline>> pipelines(phases_.size());
+                long n = 0;
+                uint64_t gap = 0;
+                for (long i = begin; i < end; i++) {
+                    if (arrivals != nullptr) {
+                        gap += arrivals->gap(i);
+                    }
+                    size_t p = phase_of(i);
+                    if (!pipelines[p]) {
+                        pipelines[p] = make_pipeline(
+                            phases_[p].config, phases_[p].mixer,
+                            insert_key_sequence_, nullptr, latest_zipfian_,
+                            counters_);
+                    }
+                    if (pipelines[p]->operation_type(i) ==
+                        loadgen::types::Type::WRITE) {
+                        n++;
+                    }
+                }
+                inserts[t] = n;
+                gaps[t] = gap;
+            }));
+        }
+        for (size_t t = 0; t < n_threads; t++) {
+            workers[t].join();
+        }
+        workers.clear();
 
-        count++;
-        progress_ = count / total;
+        // Catch the LATEST zipfian up with the inserts of previous rounds so
+        // workers only extend zetan over their own round.
+        if (latest) {
+            latest_zipfian.update_itemcount(n_records - 1 + inserted);
+        }
+
+        long base = inserted;
+        uint64_t arrival_base = arrived;
+        for (size_t t = 0; t < n_threads; t++) {
+            long begin = round + chunk_size * t;
+            long end = min(begin + chunk_size, n_operations);
+            workers.push_back(thread([this, begin, end, base, arrival_base, t,
+                                      arrivals, &buffers, &extras,
+                                      &latest_zipfian, &shards]() {
+                // Inserts are acknowledged as they are drawn, so one word
+                // of window is enough.
+                acknowledged_counter<long> counter(config_.n_records + base,
+                                                   64);
+                vector<unique_ptr<RequestPipeline>> pipelines(phases_.size());
+                RequestBatch &batch = buffers[t];
+                batch.resize(end > begin ? end - begin : 0);
+                long long extra = 0;
+                uint64_t arrival = arrival_base;
+                ByteView value;
+                for (long i = begin; i < end; i++) {
+                    size_t j = i - begin;
+                    size_t offset = batch.values.size();
+                    size_t p = phase_of(i);
+                    if (!pipelines[p]) {
+                        pipelines[p] = make_pipeline(
+                            phases_[p].config, phases_[p].mixer, &counter,
+                            nullptr, latest_zipfian, shards[t]);
+                    }
+                    RequestPipeline *pipeline = pipelines[p].get();
+                    extra += pipeline->operation(i, batch.types[j],
+                                                 batch.keys[j], value,
+                                                 batch.scan_sizes[j]);
+                    batch.values.append(value.data, value.size);
+                    batch.phases[j] = Phase::OPERATIONS;
+                    batch.phase_indices[j] = p;
+                    batch.arrival_times[j] = 0;
+                    if (arrivals != nullptr) {
+                        batch.arrival_times[j] = arrivals->time_ns(arrival);
+                        arrival += arrivals->gap(i);
+                    }
+                    batch.value_offsets[j] = offset;
+                    batch.value_lengths[j] = batch.values.size() - offset;
+                    batch.value_versions[j] =
+                        static_cast<uint64_t>(config_.n_records + i);
+                    append_multi_get_keys(*pipeline, batch, j);
+                    if (batch.types[j] == loadgen::types::Type::WRITE) {
+                        counter.acknowledge(
+                            insert_index(insert_order_.get(), batch.keys[j]));
+                    }
+                }
+                batch.count = batch.keys.size();
+                extras[t] = extra;
+            }));
+            base += inserts[t];
+            arrival_base += gaps[t];
+        }
+        for (size_t t = 0; t < n_threads; t++) {
+            workers[t].join();
+            writer->write_batch(buffers[t]);
+            extra_requests += extras[t];
+            inserted += inserts[t];
+            arrived += gaps[t];
+            if (buffers[t].count > 0) {
+                arrival_ns_ = buffers[t].arrival_times[buffers[t].count - 1];
+            }
+        }
+        workers.clear();
     }
 
-    progress_ = 1.0;
-    ofs.flush();
-    ofs.close();
+    // Leave the generator as if next() had run through the whole workload.
+    insert_key_sequence_->restart(n_records + inserted);
+    arrival_sum_ = arrived;
+    phase_index_ = phases_.size() - 1;
+    phase_entered_ = true;
+    loading_index_ = config_.n_records;
+    operations_index_ = config_.n_operations;
+    n_requests_ = config_.n_operations + extra_requests;
+    phase_ = Phase::DONE;
+    counters_->enter_phase(phase_);
+
+    writer->finish();
+    sink.close();
 }
 
 } // namespace workload
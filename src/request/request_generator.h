@@ -2,16 +2,34 @@
 #define WORKLOAD_EXPORT_REQUEST_GENERATOR_H
 
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <vector>
 #include <utility>
 
+#include "byte_view.h"
 #include "char_generator.h"
 #include "acknowledged_counter.h"
+#include "operation_mixer.h"
 #include "../types/types.h"
 
+namespace rfunc {
+class feistel_permutation;
+}
+
 namespace workload {
 
+class ArrivalProcess;
+class GeneratorCounters;
+class GeneratorMetrics;
+class KeyEncoder;
+class LiveKeySet;
+class RequestPipeline;
+class RequestStream;
+class TraceWriter;
+class ValuePool;
+
 class RequestGenerator {
 public:
     // ── Phase tracking ─────────────────────────────────────────────────
@@ -21,6 +39,48 @@ public:
         DONE
     };
 
+    /// Insert keys of the streams made by make_streams().
+    enum class StreamKeys {
+        /// Stream i of n inserts n_records + i, n_records + i + n, ...
+        /// Streams that progress at the same pace keep the inserted key
+        /// space dense.
+        INTERLEAVED,
+        /// Stream i inserts consecutive keys from n_records + the index of
+        /// its first operation, a range as large as its share of the
+        /// operations.
+        RANGES
+    };
+
+    /// One of the operation phases of Configuration::phases. A phase read
+    /// from a `[[workload.phases]]` table takes every field it leaves out
+    /// from the top-level `workload` table.
+    struct PhaseConfiguration {
+        /// Label written to the phase markers of exported traces.
+        std::string name;
+        long n_operations = 0;
+        /// Move on to the next phase after this many milliseconds of online
+        /// generation (next(), next_batch(), streams), even if operations
+        /// remain; 0 for no limit. Exported traces need operation counts.
+        long duration_ms = 0;
+        std::string data_distribution = "UNIFORM";
+        double read_proportion = 0.0;
+        double update_proportion = 0.0;
+        double insert_proportion = 0.0;
+        double scan_proportion = 0.0;
+        double delete_proportion = 0.0;
+        double read_modify_write_proportion = 0.0;
+        double multi_get_proportion = 0.0;
+        std::string scan_length_distribution = "UNIFORM";
+        long min_scan_length = 1;
+        long max_scan_length = 1000;
+        std::string multi_get_size_distribution = "UNIFORM";
+        long min_multi_get_size = 1;
+        long max_multi_get_size = 10;
+        bool gen_values = false;
+        long value_min_size = 0;
+        long value_max_size = 0;
+    };
+
     struct Configuration {
         std::string export_path;
         bool gen_values = false;
@@ -28,8 +88,8 @@ public:
         long value_max_size = 0;
         long key_seed = 0;
         long operation_seed = 0;
-        int n_records = 0;
-        int n_operations = 0;
+        long n_records = 0;
+        long n_operations = 0;
         std::string data_distribution = "UNIFORM";
         double read_proportion = 0.0;
         double update_proportion = 0.0;
@@ -37,8 +97,174 @@ public:
         double scan_proportion = 0.0;
         long scan_seed = 0;
         std::string scan_length_distribution = "UNIFORM";
-        int min_scan_length = 1;
-        int max_scan_length = 1000;
+        long min_scan_length = 1;
+        long max_scan_length = 1000;
+        double delete_proportion = 0.0;
+        /// Read followed by a write of the same key.
+        double read_modify_write_proportion = 0.0;
+        /// Reads of several keys at once.
+        double multi_get_proportion = 0.0;
+        long multi_get_seed = 0;
+        /// Keys per MULTI_GET: "UNIFORM" or "ZIPFIAN" (small batches most
+        /// frequent) over [min_multi_get_size, max_multi_get_size].
+        std::string multi_get_size_distribution = "UNIFORM";
+        long min_multi_get_size = 1;
+        long max_multi_get_size = 10;
+        /// Operation type selection: "CUMULATIVE" (historical traces) or
+        /// "ALIAS" (constant time, see OperationMixer).
+        std::string operation_mixer = "CUMULATIVE";
+        /// "SEQUENTIAL" draws from one engine per stream; "COUNTER" derives
+        /// every request from (seed, request index) so it can be generated
+        /// out of order.
+        std::string rng_mode = "SEQUENTIAL";
+        /// Engine of the SEQUENTIAL streams: "MT19937", "XOSHIRO256SS" or
+        /// "PCG64". COUNTER mode always uses rfunc::counter_engine.
+        std::string rng_engine = "MT19937";
+        long value_seed = std::mt19937::default_seed;
+        /// Zeta computation of the LATEST zipfian: "EXACT" (YCSB, O(n)
+        /// setup) or "APPROXIMATE" (constant time, see ZetaMode). Loading
+        /// records past 10^7 always use APPROXIMATE.
+        std::string zipfian_zeta = "EXACT";
+        /// READ/UPDATE/SCAN keys below the acknowledged inserts: "REJECTION"
+        /// redraws until a key falls below (YCSB); "BOUNDED" draws below
+        /// it directly (see bounded_key_sampler).
+        std::string key_sampling = "REJECTION";
+        /// Move the hot keys of ZIPFIAN and LATEST every
+        /// hotspot_drift_interval operations: "NONE", "ROTATE" (shift them by
+        /// hotspot_drift_step keys) or "EPOCH" (reseed the rank to key
+        /// mapping).
+        std::string hotspot_drift = "NONE";
+        long hotspot_drift_interval = 100000;
+        long hotspot_drift_step = 1000;
+        /// Rank to key mapping of ZIPFIAN keys: "FNV" (YCSB's hash, which
+        /// gives some keys several ranks and others none) or "PERMUTATION"
+        /// (one rank per key, see rfunc::feistel_permutation).
+        std::string zipfian_scramble = "FNV";
+        /// Keys of the loaded and inserted records: "ORDERED" (in insert
+        /// order) or "HASHED" (a permutation of [0, n_records +
+        /// n_operations), like YCSB's insertorder=hashed).
+        std::string insert_order = "ORDERED";
+        /// Bytes of the keys in CSV traces and encode_key() (see
+        /// KeyEncoder): "DECIMAL", "USER_HASH", "BINARY" or "VARIABLE".
+        std::string key_encoding = "DECIMAL";
+        /// Digits (DECIMAL, USER_HASH, VARIABLE) or bytes (BINARY) of each
+        /// key; 0 for the default of the encoding.
+        long key_width = 0;
+        /// Sizes of VARIABLE keys: "UNIFORM" or "ZIPFIAN" over
+        /// [key_min_size, key_max_size].
+        std::string key_size_distribution = "UNIFORM";
+        long key_min_size = 16;
+        long key_max_size = 64;
+        /// Intended issue times of the operations (see ArrivalProcess):
+        /// "NONE", "CONSTANT", "POISSON", "ON_OFF" (Poisson arrivals during
+        /// on periods only) or "CURVE" (Poisson arrivals at the rates of
+        /// arrival_curve).
+        std::string arrival = "NONE";
+        /// Operations per second (CONSTANT, POISSON, ON_OFF while on).
+        double arrival_rate = 0;
+        long arrival_seed = 0;
+        /// ON_OFF period lengths, in milliseconds.
+        long arrival_on_ms = 1000;
+        long arrival_off_ms = 1000;
+        /// CURVE (start second, operations per second) points; each rate
+        /// holds until the next point.
+        std::vector<std::pair<double, double>> arrival_curve;
+        /// Track deleted keys so that reads, updates, deletes and scans only
+        /// target live keys (see LiveKeySet). Defaults to on when the
+        /// workload deletes; generate_to_file() then ignores `threads`.
+        bool live_keys = false;
+        /// Inserts that may be acknowledged ahead of the oldest pending one
+        /// (see acknowledged_counter).
+        long ack_window = 1 << 20;
+        /// "RANDOM" draws every value character; "POOL" slices values out of
+        /// a pre-generated ValuePool; "DERIVED" computes them from (value_seed,
+        /// key, version) and traces only store their length and version (see
+        /// ValueDeriver).
+        std::string value_generator = "RANDOM";
+        /// Distinct value start offsets of the POOL generator, in bytes.
+        long value_pool_size = 16 << 20;
+        /// Fraction of random bytes in POOL values, in (0, 1].
+        double value_compression_ratio = 1.0;
+        /// Worker threads used by generate_to_file() in COUNTER mode without
+        /// live_keys.
+        int threads = 1;
+        /// Requests per work unit handed to a worker thread.
+        long chunk_size = 65536;
+        /// Trace encoding: "CSV" or "BINARY" (see binary_trace_format.h).
+        std::string export_format = "CSV";
+        /// Records per block of BINARY traces.
+        long block_size = 4096;
+        /// Write the trace from a background thread (see output_sink.h).
+        bool background_writer = true;
+        /// Size of each output buffer, in bytes.
+        long buffer_size = 4 << 20;
+        /// Open the trace file with O_DIRECT when supported.
+        bool direct_io = false;
+        /// File generate_to_file() writes metrics snapshots to ("-" for
+        /// stderr); empty to disable (see MetricsReporter).
+        std::string metrics_path;
+        /// Snapshot format: "JSON" or "PROMETHEUS".
+        std::string metrics_format = "JSON";
+        /// Interval between snapshots, in milliseconds.
+        long metrics_interval_ms = 1000;
+        /// Operation phases, run in order after loading and sharing the
+        /// insert keys and live keys. When set, n_operations is their total.
+        /// Empty for a single phase of n_operations with the settings above.
+        std::vector<PhaseConfiguration> phases;
+    };
+
+    /// Operation phase built by init(): the configuration its pipeline is
+    /// built from and its operation indices [begin, end).
+    struct OperationPhase {
+        Configuration config;
+        OperationMixer mixer;
+        long begin = 0;
+        long end = 0;
+        long duration_ms = 0;
+    };
+
+    /// Structure-of-arrays request buffer filled by next_batch(). The arrays
+    /// keep their capacity across calls; entry i is valid for i < count.
+    struct RequestBatch {
+        size_t count = 0;
+        std::vector<Phase> phases;
+        /// Index in Configuration::phases of entry i (0 for loading entries
+        /// and without phases).
+        std::vector<size_t> phase_indices;
+        /// Intended issue time of entry i, in nanoseconds from the first
+        /// operation (0 for loading entries and without arrivals).
+        std::vector<uint64_t> arrival_times;
+        std::vector<loadgen::types::Type> types;
+        std::vector<long> keys;
+        std::vector<long> scan_sizes;
+        /// Value of entry i: values.substr(value_offsets[i], value_lengths[i])
+        std::vector<size_t> value_offsets;
+        std::vector<size_t> value_lengths;
+        /// Version of the value of entry i (see ValueDeriver).
+        std::vector<uint64_t> value_versions;
+        /// Shared arena holding the values of the whole batch.
+        std::string values;
+        /// Keys of MULTI_GET entry i: the scan_sizes[i] keys starting at
+        /// multi_get_keys[key_offsets[i]], the first one being keys[i].
+        std::vector<size_t> key_offsets;
+        /// Shared arena holding the MULTI_GET keys of the whole batch.
+        std::vector<long> multi_get_keys;
+
+        /// Size the arrays for `n` entries and empty the arenas.
+        void resize(size_t n) {
+            phases.resize(n);
+            phase_indices.resize(n);
+            arrival_times.resize(n);
+            types.resize(n);
+            keys.resize(n);
+            scan_sizes.resize(n);
+            value_offsets.resize(n);
+            value_lengths.resize(n);
+            value_versions.resize(n);
+            key_offsets.resize(n);
+            values.clear();
+            multi_get_keys.clear();
+        }
     };
 
     /// Constructor from a TOML config file path.
@@ -48,13 +274,13 @@ public:
     /// Constructor from explicit parameters (all entries of the TOML file).
     RequestGenerator(const std::string &export_path, bool gen_values,
                      long value_min_size, long value_max_size, long key_seed,
-                     long operation_seed, int n_records, int n_operations,
+                     long operation_seed, long n_records, long n_operations,
                      const std::string &data_distribution,
                      double read_proportion, double update_proportion,
                      double insert_proportion, double scan_proportion,
                      long scan_seed,
                      const std::string &scan_length_distribution,
-                     int min_scan_length, int max_scan_length);
+                     long min_scan_length, long max_scan_length);
 
     ~RequestGenerator();
 
@@ -63,34 +289,130 @@ public:
     void generate_to_file();
 
     /// Generate all operations and dump them into the given file.
+    /// In COUNTER mode a fresh generator splits the work into chunks over
+    /// `config().threads` workers; the output does not depend on the thread
+    /// count. Loading is skipped in constant time, unless SEQUENTIAL mode
+    /// generates values: its value streams go on into the operations.
     /// @param[in] filename The name of the file to dump the operations to.
     /// @param[in] skip_loading Whether to skip the loading phase.
     void generate_to_file(const std::string &filename,
                           bool skip_loading = false);
 
+    /// Dump requests [begin, end) of the workload (loading records first,
+    /// then operations) into `filename`, the same ones the full trace holds
+    /// at those positions, so a trace can be generated as independent
+    /// segments. Requires what seek() requires.
+    void generate_range_to_file(const std::string &filename, long begin,
+                                long end);
+
     /// Get the next operation.
     /// @param[in] values       The operation types and their probabilities.
     /// @param[in] generator    The generator for the operation.
     /// @return The next operation.
-    loadgen::types::Type
-    next_operation(std::vector<std::pair<loadgen::types::Type, double>> values,
-                   rfunc::DoubleRandFunction *generator);
+    loadgen::types::Type next_operation(
+        const std::vector<std::pair<loadgen::types::Type, double>> &values,
+        rfunc::DoubleRandFunction *generator);
 
     /// Get the next operation.
-    /// @param[out] type       The operation type (READ, WRITE, SCAN).
-    /// @param[out] key        The key for the operation.
-    /// @param[out] value      The value string (non-empty only for WRITEs when
-    /// gen_values is on).
-    /// @param[out] scan_size  The scan length (non-zero only for SCAN
-    /// operations).
+    /// @param[out] type       The operation type (READ, WRITE, SCAN, DEL,
+    /// READ_MODIFY_WRITE or MULTI_GET).
+    /// @param[out] key        The key for the operation (the first key of a
+    /// MULTI_GET).
+    /// @param[out] value      The value string (non-empty only for WRITEs and
+    /// READ_MODIFY_WRITEs when gen_values is on).
+    /// @param[out] scan_size  The scan length of a SCAN or the number of keys
+    /// of a MULTI_GET (see multi_get_keys()), zero otherwise.
     /// @return phase of the returned operation
     Phase next(loadgen::types::Type &type, long &key, std::string &value,
                long &scan_size);
 
+    /// Same as next(), without copying the value: `value` points into the
+    /// value pool or into a generator buffer reused by the next call.
+    Phase next(loadgen::types::Type &type, long &key, ByteView &value,
+               long &scan_size);
+
+    /// Keys of the MULTI_GET last returned by next(), valid until the next
+    /// call.
+    const std::vector<long> &multi_get_keys() const;
+
+    /// Index in config().phases of the phase of the last operation returned
+    /// by next() or next_batch() (0 without phases).
+    size_t phase_index() const { return phase_index_; }
+
+    /// Intended issue time of the last operation returned by next(), in
+    /// nanoseconds from the first operation (0 without workload.arrival).
+    uint64_t arrival_ns() const { return arrival_ns_; }
+
+    /// Fill `batch` with up to `n` requests, the same ones that `n` calls to
+    /// next() would return. Fewer than `n` requests are returned only when
+    /// the workload ends. Phase durations are checked once per phase and
+    /// batch.
+    /// @param[in]  n                   Maximum number of requests.
+    /// @param[out] batch               Caller-owned buffer to fill.
+    /// @param[in]  acknowledge_writes  Acknowledge every WRITE as soon as it
+    /// is generated (as generate_to_file() does). Otherwise only the
+    /// acknowledgements made before the call are visible to the batch.
+    /// @return Number of requests in the batch.
+    size_t next_batch(size_t n, RequestBatch &batch,
+                      bool acknowledge_writes = false);
+
+    /// Split the whole workload into `n` client streams (see RequestStream).
+    /// SEQUENTIAL streams draw from seeds derived from the base seeds
+    /// (stream 0 keeps them; DERIVED values keep value_seed). COUNTER streams
+    /// keep the base seeds, so their requests are those of the single-stream
+    /// workload at the same indices, apart from insert keys and read bounds.
+    /// Every stream takes its share of each phase and runs the phases in
+    /// order. The generator must be initialized and outlive the streams.
+    std::vector<std::unique_ptr<RequestStream>>
+    make_streams(size_t n, StreamKeys keys = StreamKeys::INTERLEAVED) const;
+
+    /// Serialize the generation state: the position in the workload, the
+    /// insert key sequence, the live keys, the arrival schedule and the
+    /// engines and LATEST zeta sums of the pipelines. Acknowledgements past
+    /// the oldest pending insert are not part of it.
+    std::string checkpoint() const;
+
+    /// Continue from a checkpoint() of a generator with the same workload
+    /// configuration: the next requests are those the checkpointed
+    /// generator would have returned. Inserts pending at the checkpoint
+    /// must be acknowledged again, and a phase duration starts over.
+    /// @throws std::invalid_argument when the checkpoint is malformed or
+    /// was taken with another configuration; the generator is unchanged.
+    void restore(const std::string &checkpoint);
+
+    /// Position the generator so that next() returns request `index` of the
+    /// workload: loading record `index`, or operation `index - n_records`.
+    /// Needs rng_mode = "COUNTER" without live_keys. The engines are
+    /// reseeded per request, so only the insert keys and the arrival time
+    /// depend on the operations before it: their types are drawn (skipped
+    /// for phases without inserts) and their arrival gaps summed (constant
+    /// time for CONSTANT arrivals). Seeking is therefore linear in the
+    /// operations before `index` of phases with inserts. The request count
+    /// of generate_to_file() then only covers the extra accesses of later
+    /// operations.
+    /// @throws std::invalid_argument otherwise or when `index` is past the
+    /// end of the workload.
+    void seek(long index);
+
     /// Increment the acknowledged counter for the given key.
-    /// Must be called by the user after a WRITE/INSERT is confirmed.
+    /// Must be called by the user after a WRITE/INSERT is confirmed. Safe to
+    /// call from any thread, concurrently with next()/next_batch(); reads
+    /// only move past `key` once every earlier insert is acknowledged too.
     void acknowledge(long key);
 
+    /// Inserts handed out since the oldest one not acknowledged yet, that
+    /// one included; reads stay below it. Safe to call from any thread.
+    long pending_inserts() const;
+
+    /// Bytes of `key` in the key_encoding (see KeyEncoder), e.g. of the key
+    /// next() returned. The view points into a buffer of the generator that
+    /// the next call reuses; other threads encode with key_encoder() into
+    /// buffers of their own.
+    ByteView encode_key(long key);
+
+    /// Encoder of the keys.
+    const KeyEncoder &key_encoder() const;
+
     /// Reload configuration from TOML without instantiating generators.
     void load_config(const std::string &config_path);
     /// Finalize initialization after the configuration is ready.
@@ -102,7 +424,13 @@ public:
     /// True once the generator has been initialized.
     bool is_initialized() const;
 
-    /// Skip the current phase and move to the next one.
+    /// Requests, key retries, phase times and bytes generated since
+    /// initialization by the generator and the streams made from it.
+    /// @throws std::invalid_argument when the generator is not initialized.
+    const GeneratorMetrics &metrics() const;
+
+    /// Skip the current phase and move to the next one: from loading to the
+    /// first operation phase, then from each operation phase to the next.
     void skip_current_phase();
 
     /// Get the current phase.
@@ -111,25 +439,87 @@ public:
 private:
     void init();
 
+    /// Build a pipeline of `config` drawing insert keys from `counter` and
+    /// skipping the deleted `live_keys` (nullptr: none).
+    std::unique_ptr<RequestPipeline>
+    make_pipeline(const Configuration &config, const OperationMixer &mixer,
+                  acknowledged_counter<long> *counter, LiveKeySet *live_keys,
+                  const zipfian_int_distribution<long> &latest_zipfian,
+                  GeneratorCounters *counters) const;
+
+    /// Build the loading and phase pipelines from their initial state.
+    void make_pipelines(
+        std::unique_ptr<RequestPipeline> &pipeline,
+        std::vector<std::unique_ptr<RequestPipeline>> &phase_pipelines) const;
+
+    /// Operation phase of operation `index` (the last one past the end).
+    size_t phase_of(long index) const;
+
+    /// Intended issue time of operation `index`, the one after the last
+    /// operation that went through it.
+    uint64_t next_arrival(long index);
+
+    /// Move to the phase of operations_index_, past the phases that are
+    /// exhausted or out of time.
+    /// @return false once every operation phase is over.
+    bool enter_operation_phase();
+
+    static loadgen::types::Type select_operation(
+        const std::vector<std::pair<loadgen::types::Type, double>> &values,
+        double val);
+
+    void generate_to_file_parallel(const std::string &filename,
+                                   bool skip_loading);
+
+    /// Move past the loading records without returning them.
+    void skip_loading_records();
+
+    /// Write the next `count` requests to `writer` (fewer when the workload
+    /// ends), acknowledging the inserts.
+    void write_requests(TraceWriter &writer, long count);
+
     Configuration config_;
     bool initialized_ = false;
     Phase phase_;
-    int loading_index_;
-    int operations_index_;
+    long loading_index_;
+    long operations_index_;
     long long n_requests_;
-    double progress_;
 
     acknowledged_counter<long> *insert_key_sequence_;
+    bool counter_mode_ = false;
+    /// Initial state of the LATEST zipfian, copied by every pipeline.
+    zipfian_int_distribution<long> latest_zipfian_;
 
     // ── Generators ─────────────────────────────────────────────────────
-    std::vector<std::pair<loadgen::types::Type, double>> operation_proportions_;
-    rfunc::RandFunction data_generator_;
-    rfunc::RandFunction scan_length_generator_;
-    rfunc::DoubleRandFunction operation_generator_;
-    CharGenerator char_generator_;
-    rfunc::RandFunction len_generator_;
-
-    static const size_t MAX_VALUE_LEN = 10240;
+    OperationMixer operation_mixer_;
+    /// Loading pipeline, which also generates the operations without phases.
+    std::unique_ptr<RequestPipeline> pipeline_;
+    std::vector<OperationPhase> phases_;
+    /// Pipelines of phases_ when config_.phases is set.
+    std::vector<std::unique_ptr<RequestPipeline>> phase_pipelines_;
+    /// Pipeline of the current operation phase.
+    RequestPipeline *operations_pipeline_ = nullptr;
+    size_t phase_index_ = 0;
+    bool phase_entered_ = false;
+    std::chrono::steady_clock::time_point phase_deadline_;
+    /// Shared by every pipeline when value_generator is "POOL".
+    std::unique_ptr<ValuePool> value_pool_;
+    /// Key of each insert index, when config_.insert_order is "HASHED".
+    std::unique_ptr<rfunc::feistel_permutation> insert_order_;
+    std::unique_ptr<KeyEncoder> key_encoder_;
+    /// Bytes of the last encode_key(), KeyEncoder::MAX_SIZE long.
+    std::string key_buffer_;
+    /// Deletes of every pipeline above, when config_.live_keys is set.
+    std::unique_ptr<LiveKeySet> live_keys_;
+    /// Arrival schedule, when config_.arrival is not "NONE".
+    std::unique_ptr<ArrivalProcess> arrivals_;
+    /// Gaps of the operations so far, in ArrivalProcess::UNITs.
+    uint64_t arrival_sum_ = 0;
+    uint64_t arrival_ns_ = 0;
+
+    std::unique_ptr<GeneratorMetrics> metrics_;
+    /// Shard of next() and next_batch().
+    GeneratorCounters *counters_ = nullptr;
 };
 
 } // namespace workload
@@ -0,0 +1,102 @@
+#include "request_pipeline.h"
+
+namespace workload {
+using namespace std;
+using namespace rfunc;
+
+template <typename Engine, typename KeyDistribution>
+static unique_ptr<RequestPipeline>
+make_with_scan(const RequestGenerator::Configuration &config,
+               const OperationMixer &mixer,
+               acknowledged_counter<long> *counter, LiveKeySet *live_keys,
+               const zipfian_int_distribution<long> &latest_zipfian,
+               const ValuePool *value_pool,
+               const feistel_permutation *insert_order,
+               const StreamInserts &stream_inserts,
+               GeneratorCounters *counters) {
+    // Without scans the scan distribution is never drawn from.
+    Distribution scan_len_dist =
+        config.scan_proportion > 0
+            ? str_to_dist(config.scan_length_distribution)
+            : UNIFORM;
+
+    if (scan_len_dist == UNIFORM) {
+        return unique_ptr<RequestPipeline>(
+            new SpecializedRequestPipeline<Engine, KeyDistribution,
+                                           uniform_int_distribution<long>>(
+                config, mixer, counter, live_keys, latest_zipfian, value_pool,
+                insert_order, stream_inserts, counters));
+    } else if (scan_len_dist == ZIPFIAN) {
+        return unique_ptr<RequestPipeline>(
+            new SpecializedRequestPipeline<
+                Engine, KeyDistribution,
+                scrambled_zipfian_int_distribution<long>>(
+                config, mixer, counter, live_keys, latest_zipfian, value_pool,
+                insert_order, stream_inserts, counters));
+    }
+    throw invalid_argument("Unsupported scan_length_distribution: " +
+                           config.scan_length_distribution);
+}
+
+template <typename Engine>
+static unique_ptr<RequestPipeline>
+make_with_key(const RequestGenerator::Configuration &config,
+              const OperationMixer &mixer,
+              acknowledged_counter<long> *counter, LiveKeySet *live_keys,
+              const zipfian_int_distribution<long> &latest_zipfian,
+              const ValuePool *value_pool,
+              const feistel_permutation *insert_order,
+              const StreamInserts &stream_inserts,
+              GeneratorCounters *counters) {
+    Distribution data_distribution = str_to_dist(config.data_distribution);
+
+    if (data_distribution == UNIFORM) {
+        return make_with_scan<Engine, uniform_int_distribution<long>>(
+            config, mixer, counter, live_keys, latest_zipfian, value_pool,
+            insert_order, stream_inserts, counters);
+    } else if (data_distribution == ZIPFIAN) {
+        return make_with_scan<Engine,
+                              scrambled_zipfian_int_distribution<long>>(
+            config, mixer, counter, live_keys, latest_zipfian, value_pool,
+            insert_order, stream_inserts, counters);
+    } else if (data_distribution == LATEST) {
+        return make_with_scan<Engine, skewed_latest_int_distribution<long>>(
+            config, mixer, counter, live_keys, latest_zipfian, value_pool,
+            insert_order, stream_inserts, counters);
+    }
+    throw invalid_argument("Unsupported data_distribution: " +
+                           config.data_distribution);
+}
+
+unique_ptr<RequestPipeline>
+make_request_pipeline(const RequestGenerator::Configuration &config,
+                      const OperationMixer &operation_mixer,
+                      acknowledged_counter<long> *counter,
+                      LiveKeySet *live_keys,
+                      const zipfian_int_distribution<long> &latest_zipfian,
+                      const ValuePool *value_pool,
+                      const feistel_permutation *insert_order,
+                      const StreamInserts &stream_inserts,
+                      GeneratorCounters *counters) {
+    if (config.rng_mode == "COUNTER") {
+        return make_with_key<counter_engine>(
+            config, operation_mixer, counter, live_keys, latest_zipfian,
+            value_pool, insert_order, stream_inserts, counters);
+    }
+
+    Engine engine = str_to_engine(config.rng_engine);
+    if (engine == XOSHIRO256SS) {
+        return make_with_key<xoshiro256ss>(
+            config, operation_mixer, counter, live_keys, latest_zipfian,
+            value_pool, insert_order, stream_inserts, counters);
+    } else if (engine == PCG64) {
+        return make_with_key<pcg64>(config, operation_mixer, counter,
+                                    live_keys, latest_zipfian, value_pool,
+                                    insert_order, stream_inserts, counters);
+    }
+    return make_with_key<mt19937>(config, operation_mixer, counter,
+                                  live_keys, latest_zipfian, value_pool,
+                                  insert_order, stream_inserts, counters);
+}
+
+} // namespace workload
@@ -0,0 +1,638 @@
+#ifndef WORKLOAD_REQUEST_PIPELINE_H
+#define WORKLOAD_REQUEST_PIPELINE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "byte_view.h"
+#include "char_generator.h"
+#include "feistel_permutation.h"
+#include "generator_metrics.h"
+#include "live_key_set.h"
+#include "operation_mixer.h"
+#include "random.h"
+#include "request_generator.h"
+#include "stream_inserts.h"
+#include "value_deriver.h"
+#include "value_pool.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// Per-request sampling behind RequestGenerator::next().
+///
+/// Implementations are specialized on the engine and on the key and scan
+/// length distributions. make_request_pipeline() picks the specialization
+/// once, so a request costs a single virtual call and every draw inside it is
+/// inlined.
+class RequestPipeline {
+public:
+    virtual ~RequestPipeline() {}
+
+    /// Value of the loading record `index`. The view points into the value
+    /// pool or into a buffer of the pipeline that the next call reuses.
+    virtual void loading_value(long index, ByteView &value) = 0;
+
+    /// Draw only the type of operation `index` (advances the operation
+    /// stream in SEQUENTIAL mode).
+    virtual loadgen::types::Type operation_type(long index) = 0;
+
+    /// Generate operation `index`. `value` is the value of a WRITE or
+    /// READ_MODIFY_WRITE when gen_values is on and empty otherwise; it has
+    /// the lifetime described in loading_value(). `scan_size` is the length
+    /// of a SCAN or the number of keys of a MULTI_GET.
+    /// @return The extra key accesses of the operation (scan_size - 1 for
+    /// SCANs and MULTI_GETs, 1 for READ_MODIFY_WRITEs), accounted by the
+    /// caller in its request count.
+    virtual long operation(long index, loadgen::types::Type &type, long &key,
+                           ByteView &value, long &scan_size) = 0;
+
+    /// Keys of the last MULTI_GET returned by operation(), `key` first.
+    /// Reused by the next call.
+    virtual const std::vector<long> &multi_get_keys() const = 0;
+
+    /// Write the state carried from one request to the next: the engines of
+    /// SEQUENTIAL streams and the LATEST zeta sum.
+    virtual void save_state(std::ostream &os) const = 0;
+
+    /// Restore the save_state() of a pipeline built from the same
+    /// configuration.
+    virtual void load_state(std::istream &is) = 0;
+};
+
+/// Set entry `i` of `batch` to point at the end of its key arena, and append
+/// the keys of the entry when it is the MULTI_GET `pipeline` just returned.
+inline void append_multi_get_keys(const RequestPipeline &pipeline,
+                                  RequestGenerator::RequestBatch &batch,
+                                  size_t i) {
+    batch.key_offsets[i] = batch.multi_get_keys.size();
+    if (batch.types[i] == loadgen::types::Type::MULTI_GET) {
+        const std::vector<long> &keys = pipeline.multi_get_keys();
+        batch.multi_get_keys.insert(batch.multi_get_keys.end(), keys.begin(),
+                                    keys.end());
+    }
+}
+
+/// Key of the `index`-th insert (loading records first) under
+/// `insert_order`: the index itself when it is nullptr or the index is past
+/// its range.
+inline long insert_key(const rfunc::feistel_permutation *insert_order,
+                       long index) {
+    if (insert_order == nullptr ||
+        static_cast<uint64_t>(index) >= insert_order->size()) {
+        return index;
+    }
+    return static_cast<long>((*insert_order)(static_cast<uint64_t>(index)));
+}
+
+/// Insert index of `key`, the inverse of insert_key().
+inline long insert_index(const rfunc::feistel_permutation *insert_order,
+                         long key) {
+    if (insert_order == nullptr ||
+        static_cast<uint64_t>(key) >= insert_order->size()) {
+        return key;
+    }
+    return static_cast<long>(
+        insert_order->inverse(static_cast<uint64_t>(key)));
+}
+
+/// Build the pipeline matching `config` (rng_mode, rng_engine,
+/// data_distribution and scan_length_distribution).
+/// @param[in] operation_mixer Operation type selection; the pipeline keeps
+/// its own copy.
+/// @param[in] counter         Insert key sequence the pipeline draws from.
+/// @param[in] live_keys       Deleted keys to skip, updated by the DELs of
+/// the pipeline, or nullptr to draw from every key below the bound.
+/// @param[in] latest_zipfian  Initial state of the LATEST zipfian; the
+/// pipeline keeps its own copy.
+/// @param[in] value_pool      Pool values are sliced from, or nullptr to
+/// draw every character.
+/// @param[in] insert_order    Key of each insert index (see insert_key()),
+/// or nullptr for keys in insert order. The pipeline draws insert indices
+/// and returns their keys.
+/// @param[in] stream_inserts  Insert indices of the stream the pipeline
+/// generates, mapped before `insert_order`.
+/// @param[in] counters        Shard counting the operations, key retries and
+/// value bytes of the pipeline; only the pipeline may write to it.
+std::unique_ptr<RequestPipeline>
+make_request_pipeline(const RequestGenerator::Configuration &config,
+                      const OperationMixer &operation_mixer,
+                      acknowledged_counter<long> *counter,
+                      LiveKeySet *live_keys,
+                      const zipfian_int_distribution<long> &latest_zipfian,
+                      const ValuePool *value_pool,
+                      const rfunc::feistel_permutation *insert_order,
+                      const StreamInserts &stream_inserts,
+                      GeneratorCounters *counters);
+
+// ────────────────────────────────────────────────────────────────────────
+// Engine streams
+// ────────────────────────────────────────────────────────────────────────
+
+/// One random stream (keys, scan lengths, ...) of a pipeline. Regular engines
+/// are seeded once and advance across requests.
+template <typename Engine> class engine_stream {
+public:
+    static const bool per_request = false;
+
+    explicit engine_stream(long seed) : engine_(seed) {}
+
+    Engine &at(uint64_t) { return engine_; }
+
+    void save(std::ostream &os) const { os << ' ' << engine_; }
+    void load(std::istream &is) { is >> engine_; }
+
+private:
+    Engine engine_;
+};
+
+/// counter_engine streams are reseeded from (seed, request index) on every
+/// request, which makes requests independent of each other.
+template <> class engine_stream<rfunc::counter_engine> {
+public:
+    static const bool per_request = true;
+
+    explicit engine_stream(long seed) : seed_(seed) {}
+
+    rfunc::counter_engine &at(uint64_t stream) {
+        engine_.seed(seed_, stream);
+        return engine_;
+    }
+
+    /// Nothing to save: the engine is reseeded before every use.
+    void save(std::ostream &) const {}
+    void load(std::istream &) {}
+
+private:
+    uint64_t seed_;
+    rfunc::counter_engine engine_;
+};
+
+// ────────────────────────────────────────────────────────────────────────
+// Distribution construction from the configuration
+// ────────────────────────────────────────────────────────────────────────
+
+template <typename Distribution> struct distribution_factory;
+
+template <> struct distribution_factory<std::uniform_int_distribution<long>> {
+    static std::uniform_int_distribution<long>
+    key(const RequestGenerator::Configuration &config,
+        acknowledged_counter<long> *, zipfian_int_distribution<long> *) {
+        return std::uniform_int_distribution<long>(0, config.n_records);
+    }
+
+    static std::uniform_int_distribution<long>
+    scan(const RequestGenerator::Configuration &config) {
+        return std::uniform_int_distribution<long>(config.min_scan_length,
+                                                   config.max_scan_length);
+    }
+};
+
+template <>
+struct distribution_factory<scrambled_zipfian_int_distribution<long>> {
+    static scrambled_zipfian_int_distribution<long>
+    key(const RequestGenerator::Configuration &config,
+        acknowledged_counter<long> *, zipfian_int_distribution<long> *) {
+        long expectednewkeys = static_cast<long>(
+            config.n_operations * config.insert_proportion * 2.0);
+        scrambled_zipfian_int_distribution<long> distribution(
+            0, config.n_records + expectednewkeys);
+        // Like the FNV hash, the permutation does not depend on the seeds:
+        // every stream shares the hot keys.
+        if (config.zipfian_scramble == "PERMUTATION") {
+            distribution.permute(0);
+        }
+        return distribution;
+    }
+
+    static scrambled_zipfian_int_distribution<long>
+    scan(const RequestGenerator::Configuration &config) {
+        return scrambled_zipfian_int_distribution<long>(0, config.n_records);
+    }
+};
+
+template <> struct distribution_factory<skewed_latest_int_distribution<long>> {
+    static skewed_latest_int_distribution<long>
+    key(const RequestGenerator::Configuration &,
+        acknowledged_counter<long> *counter,
+        zipfian_int_distribution<long> *zip) {
+        return skewed_latest_int_distribution<long>(counter, zip);
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────
+// Bounded key draws (key_sampling = "BOUNDED")
+// ────────────────────────────────────────────────────────────────────────
+
+/// Draws of a key distribution restricted to [0, bound) without rejection.
+/// `bound` is positive.
+template <typename Distribution> struct bounded_key_sampler;
+
+template <> struct bounded_key_sampler<std::uniform_int_distribution<long>> {
+    /// Uniform over the keys of the distribution below the bound, the
+    /// distribution the rejection loop converges to.
+    template <typename Engine>
+    static long draw(std::uniform_int_distribution<long> &distribution,
+                     Engine &engine, long bound) {
+        typedef std::uniform_int_distribution<long>::param_type Range;
+        return distribution(
+            engine, Range(distribution.a(),
+                          std::min(distribution.b(), bound - 1)));
+    }
+};
+
+template <>
+struct bounded_key_sampler<scrambled_zipfian_int_distribution<long>> {
+    template <typename Engine>
+    static long draw(scrambled_zipfian_int_distribution<long> &distribution,
+                     Engine &engine, long bound) {
+        return distribution(engine, bound);
+    }
+};
+
+template <> struct bounded_key_sampler<skewed_latest_int_distribution<long>> {
+    template <typename Engine>
+    static long draw(skewed_latest_int_distribution<long> &distribution,
+                     Engine &engine, long bound) {
+        return distribution.next(engine, bound);
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────
+// Hotspot drift (hotspot_drift = "ROTATE" or "EPOCH")
+// ────────────────────────────────────────────────────────────────────────
+
+/// Moves the hot keys of a key distribution (see the drift() members of the
+/// distributions). Uniform keys have no hot spot to move.
+template <typename Distribution> struct key_drift {
+    static void apply(Distribution &, uint64_t, long) {}
+};
+
+template <> struct key_drift<scrambled_zipfian_int_distribution<long>> {
+    static void apply(scrambled_zipfian_int_distribution<long> &distribution,
+                      uint64_t salt, long rotation) {
+        distribution.drift(salt, rotation);
+    }
+};
+
+template <> struct key_drift<skewed_latest_int_distribution<long>> {
+    static void apply(skewed_latest_int_distribution<long> &distribution,
+                      uint64_t salt, long rotation) {
+        distribution.drift(salt, rotation);
+    }
+};
+
+// ────────────────────────────────────────────────────────────────────────
+// Specialized pipeline
+// ────────────────────────────────────────────────────────────────────────
+
+template <typename Engine, typename KeyDistribution,
+          typename ScanDistribution>
+class SpecializedRequestPipeline : public RequestPipeline {
+public:
+    SpecializedRequestPipeline(
+        const RequestGenerator::Configuration &config,
+        const OperationMixer &operation_mixer,
+        acknowledged_counter<long> *counter, LiveKeySet *live_keys,
+        const zipfian_int_distribution<long> &latest_zipfian,
+        const ValuePool *value_pool,
+        const rfunc::feistel_permutation *insert_order,
+        const StreamInserts &stream_inserts, GeneratorCounters *counters) :
+        gen_values_(config.gen_values), n_records_(config.n_records),
+        counter_(counter), live_keys_(live_keys), value_pool_(value_pool),
+        insert_order_(insert_order), stream_inserts_(stream_inserts),
+        map_keys_(insert_order != nullptr || !stream_inserts.identity()),
+        counters_(counters),
+        derived_values_(config.value_generator == "DERIVED"),
+        bounded_keys_(config.key_sampling == "BOUNDED"),
+        epoch_drift_(config.hotspot_drift == "EPOCH"),
+        drift_interval_(config.hotspot_drift == "NONE"
+                            ? 0
+                            : config.hotspot_drift_interval),
+        drift_step_(config.hotspot_drift_step),
+        drift_seed_(static_cast<uint64_t>(config.key_seed)),
+        deriver_(static_cast<uint64_t>(config.value_seed)),
+        operation_mixer_(operation_mixer),
+        zipfian_multi_get_size_(config.multi_get_size_distribution ==
+                                "ZIPFIAN"),
+        latest_zipfian_(latest_zipfian),
+        key_distribution_(distribution_factory<KeyDistribution>::key(
+            config, counter, &latest_zipfian_)),
+        scan_distribution_(
+            distribution_factory<ScanDistribution>::scan(config)),
+        operation_distribution_(0.0, 1.0),
+        multi_get_size_distribution_(config.min_multi_get_size,
+                                     config.max_multi_get_size),
+        len_distribution_(config.value_min_size, config.value_max_size),
+        offset_distribution_(
+            0, value_pool ? static_cast<long>(value_pool->size()) - 1 : 0),
+        key_stream_(config.key_seed), scan_stream_(config.scan_seed),
+        operation_stream_(config.operation_seed),
+        multi_get_stream_(config.multi_get_seed),
+        len_stream_(config.value_seed), char_stream_(config.value_seed) {
+        if (zipfian_multi_get_size_ && config.multi_get_proportion > 0) {
+            multi_get_size_zipfian_ = zipfian_int_distribution<long>(
+                config.min_multi_get_size, config.max_multi_get_size);
+        }
+    }
+
+    void loading_value(long index, ByteView &value) override {
+        draw_value(LOADING_STREAM_BASE + index,
+                   insert_key(insert_order_, index),
+                   static_cast<uint64_t>(index), value);
+    }
+
+    loadgen::types::Type operation_type(long index) override {
+        return draw_operation_type(index);
+    }
+
+    long operation(long index, loadgen::types::Type &type, long &key,
+                   ByteView &value, long &scan_size) override {
+        long extra_requests = 0;
+        scan_size = 0;
+        value = ByteView();
+
+        type = draw_operation_type(index);
+        counters_->add_operation(type);
+        if (drift_interval_ > 0) {
+            drift(index / drift_interval_);
+        }
+
+        switch (type) {
+        case loadgen::types::Type::READ:
+        case loadgen::types::Type::UPDATE:
+        case loadgen::types::Type::DEL:
+        case loadgen::types::Type::READ_MODIFY_WRITE: {
+            bool clamped = false;
+            key = draw_live_key(key_stream_.at(index), counter_->last_value(),
+                                0, GeneratorCounters::retries_of(type),
+                                &clamped);
+            // A clamped DEL targets key 0, which is deleted already or not
+            // inserted yet; erasing it again would hide a later insert.
+            if (type == loadgen::types::Type::DEL && live_keys_ != nullptr) {
+                if (!clamped) {
+                    live_keys_->erase(key);
+                }
+            } else if (type == loadgen::types::Type::UPDATE) {
+                type = loadgen::types::Type::WRITE;
+            } else if (type == loadgen::types::Type::READ_MODIFY_WRITE) {
+                extra_requests = 1;
+            }
+            break;
+        }
+        case loadgen::types::Type::SCAN: {
+            long size = scan_distribution_(scan_stream_.at(index));
+            scan_size = size;
+            extra_requests = size - 1;
+            key = draw_live_key(key_stream_.at(index), counter_->last_value(),
+                                size, GeneratorCounters::SCAN_RETRIES);
+            counters_->add(GeneratorCounters::SCANNED_KEYS, size);
+            break;
+        }
+        case loadgen::types::Type::MULTI_GET: {
+            Engine &size_engine = multi_get_stream_.at(index);
+            long size = zipfian_multi_get_size_
+                            ? multi_get_size_zipfian_(size_engine)
+                            : multi_get_size_distribution_(size_engine);
+            scan_size = size;
+            extra_requests = size - 1;
+            // Every key is drawn from the engine of the request, like the
+            // key of any other operation.
+            Engine &engine = key_stream_.at(index);
+            long limit = counter_->last_value();
+            multi_get_keys_.resize(static_cast<size_t>(size));
+            for (long i = 0; i < size; i++) {
+                multi_get_keys_[i] = draw_live_key(
+                    engine, limit, 0, GeneratorCounters::MULTI_GET_RETRIES);
+            }
+            key = multi_get_keys_[0];
+            counters_->add(GeneratorCounters::MULTI_GET_KEYS, size);
+            break;
+        }
+        case loadgen::types::Type::WRITE:
+            key = counter_->next();
+            break;
+        }
+
+        // Keys are drawn as insert indices of the stream, which the live
+        // keys and the LATEST ranks count in, and only mapped to their keys
+        // here.
+        if (map_keys_) {
+            key = key_of(key);
+            if (type == loadgen::types::Type::MULTI_GET) {
+                for (size_t i = 0; i < multi_get_keys_.size(); i++) {
+                    multi_get_keys_[i] = key_of(multi_get_keys_[i]);
+                }
+            }
+        }
+
+        if ((type == loadgen::types::Type::WRITE ||
+             type == loadgen::types::Type::READ_MODIFY_WRITE) &&
+            gen_values_) {
+            draw_value(index, key, static_cast<uint64_t>(n_records_ + index),
+                       value);
+        }
+
+        return extra_requests;
+    }
+
+    const std::vector<long> &multi_get_keys() const override {
+        return multi_get_keys_;
+    }
+
+    void save_state(std::ostream &os) const override {
+        os << latest_zipfian_;
+        key_stream_.save(os);
+        scan_stream_.save(os);
+        operation_stream_.save(os);
+        multi_get_stream_.save(os);
+        len_stream_.save(os);
+        char_stream_.save(os);
+    }
+
+    void load_state(std::istream &is) override {
+        is >> latest_zipfian_;
+        key_stream_.load(is);
+        scan_stream_.load(is);
+        operation_stream_.load(is);
+        multi_get_stream_.load(is);
+        len_stream_.load(is);
+        char_stream_.load(is);
+    }
+
+private:
+    /// Loading values use their own counter streams so that they never
+    /// overlap the streams of the operations with the same index.
+    static const uint64_t LOADING_STREAM_BASE = 1ULL << 63;
+
+    long key_of(long index) const {
+        return insert_key(insert_order_, stream_inserts_.to_workload(index));
+    }
+
+    loadgen::types::Type draw_operation_type(long index) {
+        return operation_mixer_.select(
+            operation_distribution_(operation_stream_.at(index)));
+    }
+
+    /// Move the hot keys to their place in drift epoch `epoch`; epoch 0 keeps
+    /// the original mapping.
+    void drift(long epoch) {
+        if (epoch == drift_epoch_) {
+            return;
+        }
+        drift_epoch_ = epoch;
+        if (epoch_drift_) {
+            uint64_t salt =
+                epoch == 0
+                    ? 0
+                    : rfunc::counter_engine(drift_seed_,
+                                            static_cast<uint64_t>(epoch))();
+            key_drift<KeyDistribution>::apply(key_distribution_, salt, 0);
+        } else {
+            key_drift<KeyDistribution>::apply(key_distribution_, 0,
+                                              epoch * drift_step_);
+        }
+    }
+
+    /// Key below `bound`, by rejection or BOUNDED sampling; rejected draws
+    /// are counted in `retries`.
+    long draw_key(Engine &engine, long bound,
+                  GeneratorCounters::Counter retries) {
+        if (bounded_keys_) {
+            return draw_bounded_key(engine, bound);
+        }
+        long key;
+        long draws = 0;
+        do {
+            key = key_distribution_(engine);
+            draws++;
+        } while (key >= bound);
+        counters_->add(retries, draws - 1);
+        return key;
+    }
+
+    /// Key below `limit` with at least `margin` keys between it and
+    /// `limit`. With live keys the draw is a rank among the live keys, then
+    /// mapped to its key, so deleted keys are never returned. When no live
+    /// key is far enough below `limit`, the draw is clamped to key 0 like a
+    /// BOUNDED one, and `clamped` (if given) is set.
+    long draw_live_key(Engine &engine, long limit, long margin,
+                       GeneratorCounters::Counter retries,
+                       bool *clamped = nullptr) {
+        if (live_keys_ == nullptr) {
+            return draw_key(engine, limit - margin, retries);
+        }
+        long bound = live_keys_->rank(limit) - margin;
+        // Rank 0 would select the first live key at or past `limit`, which
+        // is not inserted yet, and rejection would never end.
+        if (bound <= 0) {
+            counters_->add(GeneratorCounters::CLAMPED_KEYS, 1);
+            if (clamped != nullptr) {
+                *clamped = true;
+            }
+            return 0;
+        }
+        // LATEST ranks count down from the bound, which shrinks with every
+        // delete; rejection would cut off the hottest keys instead.
+        long rank = std::is_same<KeyDistribution,
+                                 skewed_latest_int_distribution<long>>::value
+                        ? draw_bounded_key(engine, bound)
+                        : draw_key(engine, bound, retries);
+        return live_keys_->select(rank);
+    }
+
+    /// Key below `bound`, or key 0 when no key is below it (nothing
+    /// inserted yet, or a scan longer than the inserted range), where the
+    /// rejection loop would never end.
+    long draw_bounded_key(Engine &engine, long bound) {
+        if (bound <= 0) {
+            counters_->add(GeneratorCounters::CLAMPED_KEYS, 1);
+            return 0;
+        }
+        return bounded_key_sampler<KeyDistribution>::draw(key_distribution_,
+                                                          engine, bound);
+    }
+
+    void draw_value(uint64_t stream, long key, uint64_t version,
+                    ByteView &value) {
+        Engine &len_engine = len_stream_.at(stream);
+        long length = len_distribution_(len_engine);
+        counters_->add(GeneratorCounters::VALUE_BYTES, length);
+        if (derived_values_) {
+            scratch_.resize(static_cast<size_t>(length));
+            deriver_.fill(key, version, &scratch_[0], scratch_.size());
+            value = ByteView(scratch_.data(), scratch_.size());
+            return;
+        }
+        // Counter streams draw the characters right after the length; the
+        // sequential streams keep separate length and character engines.
+        Engine &char_engine = engine_stream<Engine>::per_request
+                                  ? len_engine
+                                  : char_stream_.at(stream);
+        if (value_pool_ != nullptr) {
+            long offset = offset_distribution_(char_engine);
+            value = value_pool_->slice(static_cast<size_t>(offset),
+                                       static_cast<size_t>(length));
+            return;
+        }
+        scratch_.resize(static_cast<size_t>(length));
+        char *out = &scratch_[0];
+        for (long i = 0; i < length; i++) {
+            out[i] = CharGenerator::draw(char_engine);
+        }
+        value = ByteView(scratch_.data(), scratch_.size());
+    }
+
+    bool gen_values_;
+    long n_records_;
+    acknowledged_counter<long> *counter_;
+    LiveKeySet *live_keys_;
+    const ValuePool *value_pool_;
+    const rfunc::feistel_permutation *insert_order_;
+    StreamInserts stream_inserts_;
+    /// Whether insert indices differ from their keys.
+    bool map_keys_;
+    GeneratorCounters *counters_;
+    bool derived_values_;
+    bool bounded_keys_;
+    bool epoch_drift_;
+    /// Operations per drift epoch, 0 without drift.
+    long drift_interval_;
+    long drift_step_;
+    uint64_t drift_seed_;
+    long drift_epoch_ = 0;
+    ValueDeriver deriver_;
+    std::string scratch_;
+    OperationMixer operation_mixer_;
+    bool zipfian_multi_get_size_;
+    std::vector<long> multi_get_keys_;
+
+    zipfian_int_distribution<long> latest_zipfian_;
+    KeyDistribution key_distribution_;
+    ScanDistribution scan_distribution_;
+    std::uniform_real_distribution<double> operation_distribution_;
+    std::uniform_int_distribution<long> multi_get_size_distribution_;
+    zipfian_int_distribution<long> multi_get_size_zipfian_;
+    std::uniform_int_distribution<long> len_distribution_;
+    std::uniform_int_distribution<long> offset_distribution_;
+
+    engine_stream<Engine> key_stream_;
+    engine_stream<Engine> scan_stream_;
+    engine_stream<Engine> operation_stream_;
+    engine_stream<Engine> multi_get_stream_;
+    engine_stream<Engine> len_stream_;
+    engine_stream<Engine> char_stream_;
+};
+
+} // namespace workload
+
+#endif
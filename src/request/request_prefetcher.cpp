@@ -0,0 +1,277 @@
+#include "request_prefetcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+/// Requests the producer generates per call to next_batch().
+static const size_t CHUNK = 64;
+
+/// Spins before a waiting thread starts to sleep.
+static const int SPINS = 256;
+
+// Wait until `ready()` or `stop`. The other thread usually catches up within
+// a few yields; a thread that keeps waiting sleeps instead of taking a core
+// away from it.
+template <typename Ready>
+static bool wait_until(const atomic<bool> &stop, Ready ready) {
+    for (int i = 0; !ready(); i++) {
+        if (stop.load(memory_order_relaxed)) {
+            return false;
+        }
+        if (i < SPINS) {
+            this_thread::yield();
+        } else {
+            this_thread::sleep_for(chrono::microseconds(20));
+        }
+    }
+    return true;
+}
+
+RequestPrefetcher::RequestPrefetcher(RequestGenerator &generator,
+                                     const Options &options) :
+    generator_(generator), current_(&idle_), head_(0), tail_(0),
+    arena_tail_(0), stop_(false) {
+    if (!generator.is_initialized()) {
+        throw invalid_argument("RequestPrefetcher needs an initialized "
+                               "generator");
+    }
+    if (options.capacity == 0 || options.arena_size == 0 ||
+        options.max_pending <= 0) {
+        throw invalid_argument("RequestPrefetcher options must be positive");
+    }
+    size_t capacity = 1;
+    while (capacity < options.capacity) {
+        capacity <<= 1;
+    }
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+    max_pending_ = min(options.max_pending, generator.config().ack_window);
+
+    // With four times the largest value, a value that does not fit before
+    // the end of the arena still fits at its start once the consumer
+    // released everything but the value it holds.
+    const RequestGenerator::Configuration &config = generator.config();
+    long value_max_size = config.value_max_size;
+    for (size_t i = 0; i < config.phases.size(); i++) {
+        value_max_size = max(value_max_size, config.phases[i].value_max_size);
+    }
+    arena_size_ = max(options.arena_size,
+                      4 * static_cast<size_t>(max(value_max_size, 1L)));
+    arena_.reset(new char[arena_size_]);
+
+    producer_ = thread(&RequestPrefetcher::produce, this);
+}
+
+RequestPrefetcher::~RequestPrefetcher() {
+    cancel();
+    producer_.join();
+}
+
+void RequestPrefetcher::cancel() { stop_ = true; }
+
+// ────────────────────────────────────────────────────────────────────────
+// Producer
+// ────────────────────────────────────────────────────────────────────────
+void RequestPrefetcher::produce() {
+    try {
+        for (;;) {
+            // Every request inserts at most one key, so a batch no larger
+            // than the inserts left under the bound stays within it.
+            size_t n = 0;
+            bool ready = wait_until(stop_, [&]() {
+                size_t free = slots_.size() -
+                              static_cast<size_t>(
+                                  produced_ - tail_.load(memory_order_acquire));
+                long room = max_pending_ - generator_.pending_inserts();
+                n = min(min(free, CHUNK),
+                        static_cast<size_t>(max(room, 0L)));
+                return n > 0;
+            });
+            if (!ready) {
+                return;
+            }
+            size_t count = generator_.next_batch(n, batch_);
+            if (!push(count)) {
+                return;
+            }
+            if (count < n) {
+                break;
+            }
+        }
+    } catch (...) {
+        error_ = current_exception();
+    }
+
+    // The last slot marks the end of the workload, or the error.
+    bool ready = wait_until(stop_, [this]() {
+        return produced_ - tail_.load(memory_order_acquire) < slots_.size();
+    });
+    if (!ready) {
+        return;
+    }
+    Slot &slot = slots_[produced_ & mask_];
+    slot.phase = RequestGenerator::Phase::DONE;
+    slot.arena_end = arena_head_;
+    head_.store(produced_ + 1, memory_order_release);
+}
+
+bool RequestPrefetcher::push(size_t count) {
+    const RequestGenerator::RequestBatch &batch = batch_;
+    for (size_t i = 0; i < count; i++) {
+        Slot &slot = slots_[produced_ & mask_];
+        size_t size = batch.value_lengths[i];
+        if (!reserve_value(size, slot.value_offset)) {
+            return false;
+        }
+        memcpy(arena_.get() + slot.value_offset,
+               batch.values.data() + batch.value_offsets[i], size);
+        slot.value_size = size;
+        slot.arena_end = arena_head_;
+        slot.phase = batch.phases[i];
+        slot.phase_index = batch.phase_indices[i];
+        slot.arrival_ns = batch.arrival_times[i];
+        slot.type = batch.types[i];
+        slot.key = batch.keys[i];
+        slot.scan_size = batch.scan_sizes[i];
+        slot.value_version = batch.value_versions[i];
+        if (slot.type == loadgen::types::Type::MULTI_GET) {
+            const long *keys =
+                batch.multi_get_keys.data() + batch.key_offsets[i];
+            slot.multi_get_keys.assign(keys, keys + slot.scan_size);
+        } else {
+            slot.multi_get_keys.clear();
+        }
+        head_.store(++produced_, memory_order_release);
+    }
+    return true;
+}
+
+bool RequestPrefetcher::reserve_value(size_t size, size_t &offset) {
+    if (size > arena_size_ / 4) {
+        throw runtime_error("Value larger than the prefetch arena allows");
+    }
+    // Values are contiguous: one that would wrap starts over at offset 0.
+    uint64_t begin = arena_head_;
+    size_t position = static_cast<size_t>(begin % arena_size_);
+    if (position + size > arena_size_) {
+        begin += arena_size_ - position;
+    }
+    bool ready = wait_until(stop_, [&]() {
+        return begin + size - arena_tail_.load(memory_order_acquire) <=
+               arena_size_;
+    });
+    if (!ready) {
+        return false;
+    }
+    offset = static_cast<size_t>(begin % arena_size_);
+    arena_head_ = begin + size;
+    return true;
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// Consumer
+// ────────────────────────────────────────────────────────────────────────
+bool RequestPrefetcher::take() {
+    if (stop_.load(memory_order_relaxed)) {
+        return false;
+    }
+    if (consumed_ >= ready_) {
+        bool ready = wait_until(stop_, [this]() {
+            ready_ = head_.load(memory_order_acquire);
+            return consumed_ < ready_;
+        });
+        if (!ready) {
+            return false;
+        }
+    }
+    if (slots_[consumed_ & mask_].phase != RequestGenerator::Phase::DONE) {
+        return true;
+    }
+    if (error_) {
+        rethrow_exception(error_);
+    }
+    return false;
+}
+
+void RequestPrefetcher::release() {
+    arena_tail_.store(slots_[(consumed_ - 1) & mask_].arena_end,
+                      memory_order_release);
+    tail_.store(consumed_, memory_order_release);
+}
+
+RequestGenerator::Phase RequestPrefetcher::next(loadgen::types::Type &type,
+                                                long &key, ByteView &value,
+                                                long &scan_size) {
+    if (holding_) {
+        release();
+        holding_ = false;
+    }
+    value = ByteView();
+    scan_size = 0;
+    current_ = &idle_;
+    if (!take()) {
+        return RequestGenerator::Phase::DONE;
+    }
+
+    const Slot &slot = slots_[consumed_ & mask_];
+    type = slot.type;
+    key = slot.key;
+    if (slot.value_size > 0) {
+        value = ByteView(arena_.get() + slot.value_offset, slot.value_size);
+    }
+    scan_size = slot.scan_size;
+    current_ = &slot;
+    consumed_++;
+    holding_ = true;
+    return slot.phase;
+}
+
+const std::vector<long> &RequestPrefetcher::multi_get_keys() const {
+    return current_->multi_get_keys;
+}
+
+size_t RequestPrefetcher::next_batch(size_t n,
+                                     RequestGenerator::RequestBatch &batch) {
+    if (holding_) {
+        release();
+        holding_ = false;
+    }
+    current_ = &idle_;
+    batch.resize(n);
+    size_t count = 0;
+    if (n > 0 && take()) {
+        ready_ = head_.load(memory_order_acquire);
+        uint64_t end = min(ready_, consumed_ + n);
+        for (; consumed_ < end; consumed_++, count++) {
+            const Slot &slot = slots_[consumed_ & mask_];
+            if (slot.phase == RequestGenerator::Phase::DONE) {
+                break;
+            }
+            batch.phases[count] = slot.phase;
+            batch.phase_indices[count] = slot.phase_index;
+            batch.arrival_times[count] = slot.arrival_ns;
+            batch.types[count] = slot.type;
+            batch.keys[count] = slot.key;
+            batch.scan_sizes[count] = slot.scan_size;
+            batch.value_offsets[count] = batch.values.size();
+            batch.value_lengths[count] = slot.value_size;
+            batch.value_versions[count] = slot.value_version;
+            batch.values.append(arena_.get() + slot.value_offset,
+                                slot.value_size);
+            batch.key_offsets[count] = batch.multi_get_keys.size();
+            batch.multi_get_keys.insert(batch.multi_get_keys.end(),
+                                        slot.multi_get_keys.begin(),
+                                        slot.multi_get_keys.end());
+        }
+        release();
+    }
+    batch.count = count;
+    return count;
+}
+
+} // namespace workload
@@ -0,0 +1,165 @@
+#ifndef WORKLOAD_REQUEST_PREFETCHER_H
+#define WORKLOAD_REQUEST_PREFETCHER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "byte_view.h"
+#include "request_generator.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// Generates the requests of a RequestGenerator ahead of time on a
+/// background thread, so that the thread taking them only pays for a copy.
+///
+/// The producer thread fills a ring of `capacity` slots, shared with the
+/// consumer without locks (one producer, one consumer), and copies the value
+/// bytes into an arena it reuses once the consumer released them. The
+/// requests are those next_batch() of the generator would return.
+///
+/// Reads of LATEST keys are bounded by the inserts acknowledged when they
+/// are generated, which may be a ring earlier than they are taken. The
+/// producer therefore stops while `max_pending` inserts handed out are not
+/// acknowledged (RequestGenerator::pending_inserts()), inserts still in the
+/// ring included, so bounds lag behind the store by at most that many keys.
+/// The consumer must acknowledge the inserts it takes, or it waits forever
+/// once the bound is reached. Phase durations are checked when requests are
+/// generated, up to a ring earlier than they are taken.
+///
+/// The generator must be initialized and outlive the prefetcher. Until the
+/// prefetcher is destroyed, only acknowledge() and metrics() may be called
+/// on the generator, from any thread; the other members of the prefetcher
+/// are called from one thread at a time.
+class RequestPrefetcher {
+public:
+    struct Options {
+        /// Requests generated ahead, rounded up to a power of two.
+        size_t capacity = 4096;
+        /// Bytes of the value arena, raised to four times the largest
+        /// value of the workload.
+        size_t arena_size = 16 << 20;
+        /// Unacknowledged inserts the producer may hand out, at most the
+        /// ack_window of the generator.
+        long max_pending = 1024;
+    };
+
+    /// Start the producer thread.
+    /// @throws std::invalid_argument when the generator is not initialized
+    /// or an option is not positive.
+    RequestPrefetcher(RequestGenerator &generator, const Options &options);
+
+    /// Stop the producer thread, dropping the requests not taken.
+    ~RequestPrefetcher();
+
+    /// Stop producing: next() and next_batch() then return DONE and 0,
+    /// including a call waiting for the producer. Safe to call from any
+    /// thread, e.g. when a consumer gives up on the inserts it took, which
+    /// the producer would otherwise wait for forever.
+    void cancel();
+
+    RequestPrefetcher(const RequestPrefetcher &) = delete;
+    RequestPrefetcher &operator=(const RequestPrefetcher &) = delete;
+
+    /// Same as RequestGenerator::next(), waiting for the producer when the
+    /// ring is empty. `value` points into the arena until the next call.
+    /// @throws what the generator threw while producing the request.
+    RequestGenerator::Phase next(loadgen::types::Type &type, long &key,
+                                 ByteView &value, long &scan_size);
+
+    /// Keys of the MULTI_GET last returned by next(), valid until the next
+    /// call.
+    const std::vector<long> &multi_get_keys() const;
+
+    /// Index in the generator's phases of the last operation returned by
+    /// next().
+    size_t phase_index() const { return current_->phase_index; }
+
+    /// Intended issue time of the last operation returned by next().
+    uint64_t arrival_ns() const { return current_->arrival_ns; }
+
+    /// Fill `batch` with up to `n` requests ready in the ring, waiting only
+    /// for the first one: unlike RequestGenerator::next_batch(), a batch
+    /// may be short before the workload ends, so that the consumer can
+    /// acknowledge its inserts and let the producer go on.
+    /// @return Number of requests in the batch, 0 once the workload ended.
+    size_t next_batch(size_t n, RequestGenerator::RequestBatch &batch);
+
+    /// Acknowledge an insert to the generator.
+    void acknowledge(long key) { generator_.acknowledge(key); }
+
+private:
+    /// A request of the ring; its value lies in the arena.
+    struct Slot {
+        RequestGenerator::Phase phase = RequestGenerator::Phase::DONE;
+        size_t phase_index = 0;
+        uint64_t arrival_ns = 0;
+        loadgen::types::Type type = loadgen::types::Type::READ;
+        long key = 0;
+        long scan_size = 0;
+        uint64_t value_version = 0;
+        size_t value_offset = 0;
+        size_t value_size = 0;
+        /// Arena bytes reserved up to and including this value.
+        uint64_t arena_end = 0;
+        std::vector<long> multi_get_keys;
+    };
+
+    void produce();
+    /// Copy the requests of `count` entries of batch_ into the ring.
+    /// @return false when stopped.
+    bool push(size_t count);
+    /// Reserve `size` contiguous arena bytes, waiting for the consumer.
+    /// @return false when stopped.
+    bool reserve_value(size_t size, size_t &offset);
+    /// Wait for the producer to publish slot consumed_.
+    /// @return false when the workload ended (the slot is the last one) or
+    /// the prefetcher was cancelled.
+    /// @throws what the generator threw.
+    bool take();
+    /// Give the slots before consumed_ back to the producer.
+    void release();
+
+    RequestGenerator &generator_;
+    size_t mask_;
+    long max_pending_;
+    std::vector<Slot> slots_;
+    std::unique_ptr<char[]> arena_;
+    size_t arena_size_;
+
+    // Producer side. Slots and arena positions only grow; the slot of index
+    // i is slots_[i & mask_], its arena bytes at offset position % size.
+    uint64_t produced_ = 0;
+    uint64_t arena_head_ = 0;
+    RequestGenerator::RequestBatch batch_;
+    std::exception_ptr error_;
+
+    // Consumer side. next() keeps the slot it returned until the next call.
+    uint64_t consumed_ = 0;
+    /// Last value of head_ read.
+    uint64_t ready_ = 0;
+    bool holding_ = false;
+    /// Request last returned by next(), or idle_.
+    const Slot *current_;
+    Slot idle_;
+
+    /// Slots published by the producer.
+    std::atomic<uint64_t> head_;
+    /// Keeps head_ and tail_, written by different threads, on different
+    /// cache lines.
+    char padding_[64];
+    /// Slots released by the consumer, and the end of their arena bytes.
+    std::atomic<uint64_t> tail_;
+    std::atomic<uint64_t> arena_tail_;
+    std::atomic<bool> stop_;
+    std::thread producer_;
+};
+
+} // namespace workload
+
+#endif
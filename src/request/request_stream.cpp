@@ -0,0 +1,228 @@
+#include "request_stream.h"
+#include "arrival_process.h"
+#include "generator_metrics.h"
+#include "live_key_set.h"
+#include "request_pipeline.h"
+
+#include <algorithm>
+
+namespace workload {
+using namespace std;
+
+// ────────────────────────────────────────────────────────────────────────
+// Construction
+// ────────────────────────────────────────────────────────────────────────
+RequestStream::RequestStream(
+    const RequestGenerator::Configuration &config,
+    const OperationMixer &operation_mixer,
+    const std::vector<OperationPhase> &phases,
+    const zipfian_int_distribution<long> &latest_zipfian,
+    const ValuePool *value_pool,
+    const rfunc::feistel_permutation *insert_order,
+    GeneratorCounters *counters, long loading_begin, long loading_end,
+    long insert_key_start, long insert_key_stride) :
+    loading_begin_(loading_begin), loading_end_(loading_end), operations_(0),
+    n_records_(config.n_records), gen_values_(config.gen_values),
+    phase_(Phase::LOADING), loading_index_(loading_begin),
+    operations_index_(phases.front().begin), n_requests_(0),
+    insert_keys_(config.n_records, static_cast<size_t>(config.ack_window)),
+    stream_inserts_(config.n_records, insert_key_start, insert_key_stride),
+    insert_order_(insert_order), key_encoder_(config), counters_(counters),
+    live_keys_(config.live_keys ? new LiveKeySet() : nullptr),
+    phases_(phases), phase_index_(0), phase_entered_(false) {
+    pipeline_ = make_request_pipeline(config, operation_mixer, &insert_keys_,
+                                      live_keys_.get(), latest_zipfian,
+                                      value_pool, insert_order,
+                                      stream_inserts_, counters_);
+    for (size_t i = 0; i < phases_.size(); i++) {
+        operations_ += phases_[i].end - phases_[i].begin;
+        if (!config.phases.empty()) {
+            phase_pipelines_.push_back(make_request_pipeline(
+                phases_[i].config, phases_[i].mixer, &insert_keys_,
+                live_keys_.get(), latest_zipfian, value_pool, insert_order,
+                stream_inserts_, counters_));
+        }
+    }
+    operations_pipeline_ = phase_pipelines_.empty()
+                               ? pipeline_.get()
+                               : phase_pipelines_[0].get();
+    if (config.arrival != "NONE") {
+        arrivals_.reset(new ArrivalProcess(config));
+    }
+}
+
+RequestStream::~RequestStream() {}
+
+// ────────────────────────────────────────────────────────────────────────
+// next()
+// ────────────────────────────────────────────────────────────────────────
+RequestStream::Phase RequestStream::next(loadgen::types::Type &type,
+                                         long &key, std::string &value,
+                                         long &scan_size) {
+    ByteView view;
+    Phase phase = next(type, key, view, scan_size);
+    value.assign(view.data, view.size);
+    return phase;
+}
+
+RequestStream::Phase RequestStream::next(loadgen::types::Type &type,
+                                         long &key, ByteView &value,
+                                         long &scan_size) {
+    value = ByteView();
+    scan_size = 0;
+
+    if (phase_ == Phase::DONE) {
+        return phase_;
+    }
+    counters_->enter_phase(phase_);
+
+    if (phase_ == Phase::LOADING) {
+        if (loading_index_ < loading_end_) {
+            type = loadgen::types::Type::WRITE;
+            key = insert_key(insert_order_, loading_index_);
+            if (gen_values_) {
+                pipeline_->loading_value(loading_index_, value);
+            }
+            counters_->add(GeneratorCounters::LOADED, 1);
+            loading_index_++;
+            return phase_;
+        }
+        phase_ = Phase::OPERATIONS;
+        counters_->enter_phase(phase_);
+    }
+
+    if (phase_ == Phase::OPERATIONS) {
+        if (enter_operation_phase()) {
+            n_requests_ += 1 + operations_pipeline_->operation(
+                                   operations_index_, type, key, value,
+                                   scan_size);
+            next_arrival(operations_index_);
+            operations_index_++;
+            return phase_;
+        }
+        phase_ = Phase::DONE;
+        counters_->enter_phase(phase_);
+    }
+
+    return phase_;
+}
+
+uint64_t RequestStream::next_arrival(long index) {
+    if (!arrivals_) {
+        return 0;
+    }
+    arrival_ns_ = arrivals_->time_ns(arrival_sum_);
+    arrival_sum_ += arrivals_->gap(index);
+    return arrival_ns_;
+}
+
+const std::vector<long> &RequestStream::multi_get_keys() const {
+    return operations_pipeline_->multi_get_keys();
+}
+
+bool RequestStream::enter_operation_phase() {
+    while (true) {
+        const OperationPhase &phase = phases_[phase_index_];
+        if (!phase_entered_) {
+            phase_entered_ = true;
+            operations_index_ = max(operations_index_, phase.begin);
+            operations_pipeline_ = phase_pipelines_.empty()
+                                       ? pipeline_.get()
+                                       : phase_pipelines_[phase_index_].get();
+            if (phase.duration_ms > 0) {
+                phase_deadline_ = chrono::steady_clock::now() +
+                                  chrono::milliseconds(phase.duration_ms);
+            }
+        }
+        if (operations_index_ < phase.end &&
+            (phase.duration_ms == 0 ||
+             chrono::steady_clock::now() < phase_deadline_)) {
+            return true;
+        }
+        if (phase_index_ + 1 == phases_.size()) {
+            operations_index_ = phase.end;
+            return false;
+        }
+        phase_index_++;
+        phase_entered_ = false;
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// next_batch()
+// ────────────────────────────────────────────────────────────────────────
+size_t RequestStream::next_batch(size_t n, RequestBatch &batch,
+                                 bool acknowledge_writes) {
+    batch.resize(n);
+
+    size_t count = 0;
+    ByteView value;
+    while (count < n && phase_ != Phase::DONE) {
+        counters_->enter_phase(phase_);
+        if (phase_ == Phase::LOADING) {
+            if (loading_index_ >= loading_end_) {
+                phase_ = Phase::OPERATIONS;
+                continue;
+            }
+            long end = min(loading_index_ + static_cast<long>(n - count),
+                           loading_end_);
+            for (long i = loading_index_; i < end; i++, count++) {
+                size_t offset = batch.values.size();
+                if (gen_values_) {
+                    pipeline_->loading_value(i, value);
+                    batch.values.append(value.data, value.size);
+                }
+                batch.phases[count] = Phase::LOADING;
+                batch.phase_indices[count] = 0;
+                batch.arrival_times[count] = 0;
+                batch.types[count] = loadgen::types::Type::WRITE;
+                batch.keys[count] = insert_key(insert_order_, i);
+                batch.scan_sizes[count] = 0;
+                batch.value_offsets[count] = offset;
+                batch.value_lengths[count] = batch.values.size() - offset;
+                batch.value_versions[count] = static_cast<uint64_t>(i);
+                batch.key_offsets[count] = batch.multi_get_keys.size();
+            }
+            counters_->add(GeneratorCounters::LOADED, end - loading_index_);
+            loading_index_ = end;
+        } else {
+            if (!enter_operation_phase()) {
+                phase_ = Phase::DONE;
+                counters_->enter_phase(phase_);
+                continue;
+            }
+            long end = min(operations_index_ + static_cast<long>(n - count),
+                           phases_[phase_index_].end);
+            for (long i = operations_index_; i < end; i++, count++) {
+                size_t offset = batch.values.size();
+                n_requests_ += 1 + operations_pipeline_->operation(
+                                       i, batch.types[count], batch.keys[count],
+                                       value, batch.scan_sizes[count]);
+                batch.values.append(value.data, value.size);
+                batch.phases[count] = Phase::OPERATIONS;
+                batch.phase_indices[count] = phase_index_;
+                batch.arrival_times[count] = next_arrival(i);
+                batch.value_offsets[count] = offset;
+                batch.value_lengths[count] = batch.values.size() - offset;
+                batch.value_versions[count] =
+                    static_cast<uint64_t>(n_records_ + i);
+                append_multi_get_keys(*operations_pipeline_, batch, count);
+                if (acknowledge_writes &&
+                    batch.types[count] == loadgen::types::Type::WRITE) {
+                    acknowledge(batch.keys[count]);
+                }
+            }
+            operations_index_ = end;
+        }
+    }
+
+    batch.count = count;
+    return count;
+}
+
+void RequestStream::acknowledge(long key) {
+    insert_keys_.acknowledge(
+        stream_inserts_.to_stream(insert_index(insert_order_, key)));
+}
+
+} // namespace workload
@@ -0,0 +1,144 @@
+#ifndef WORKLOAD_REQUEST_STREAM_H
+#define WORKLOAD_REQUEST_STREAM_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "acknowledged_counter.h"
+#include "byte_view.h"
+#include "key_encoder.h"
+#include "request_generator.h"
+#include "stream_inserts.h"
+#include "../types/types.h"
+
+namespace workload {
+
+class ArrivalProcess;
+class GeneratorCounters;
+class LiveKeySet;
+class RequestPipeline;
+
+/// One of the client streams a RequestGenerator workload is split into.
+///
+/// Each stream owns its pipeline and insert key counter and shares nothing
+/// mutable with the other streams, so every stream can be driven from its own
+/// thread without locks. Stream i of n covers the i-th block of the loading
+/// records and of the operations; the loading keys and value versions are
+/// those of the single-stream workload. A stream reads the loading records
+/// and the inserts acknowledged to it, never the keys of the other streams:
+/// its read bound starts at the last loading record and follows its own
+/// inserts, mapped to its insert keys (see StreamInserts), so no read
+/// targets a key that is not inserted yet. With live_keys set, reads only
+/// skip the keys deleted by the stream itself.
+///
+/// Streams use the value pool and insert order and count into the metrics of
+/// the generator that made them and must not outlive it.
+class RequestStream {
+public:
+    typedef RequestGenerator::Phase Phase;
+    typedef RequestGenerator::RequestBatch RequestBatch;
+
+    typedef RequestGenerator::OperationPhase OperationPhase;
+
+    /// Use RequestGenerator::make_streams(). `phases` hold the operation
+    /// indices of the stream.
+    RequestStream(const RequestGenerator::Configuration &config,
+                  const OperationMixer &operation_mixer,
+                  const std::vector<OperationPhase> &phases,
+                  const zipfian_int_distribution<long> &latest_zipfian,
+                  const ValuePool *value_pool,
+                  const rfunc::feistel_permutation *insert_order,
+                  GeneratorCounters *counters, long loading_begin,
+                  long loading_end, long insert_key_start,
+                  long insert_key_stride);
+    ~RequestStream();
+
+    RequestStream(const RequestStream &) = delete;
+    RequestStream &operator=(const RequestStream &) = delete;
+
+    /// Same as RequestGenerator::next().
+    Phase next(loadgen::types::Type &type, long &key, ByteView &value,
+               long &scan_size);
+
+    /// Same as RequestGenerator::next(), copying the value.
+    Phase next(loadgen::types::Type &type, long &key, std::string &value,
+               long &scan_size);
+
+    /// Same as RequestGenerator::multi_get_keys().
+    const std::vector<long> &multi_get_keys() const;
+
+    /// Same as RequestGenerator::next_batch().
+    size_t next_batch(size_t n, RequestBatch &batch,
+                      bool acknowledge_writes = false);
+
+    /// Acknowledge an insert of this stream.
+    void acknowledge(long key);
+
+    /// Same as RequestGenerator::encode_key().
+    ByteView encode_key(long key) {
+        return ByteView(key_buffer_, key_encoder_.encode(key, key_buffer_));
+    }
+
+    Phase current_phase() const { return phase_; }
+
+    /// Same as RequestGenerator::phase_index().
+    size_t phase_index() const { return phase_index_; }
+
+    /// Same as RequestGenerator::arrival_ns(); streams of make_streams()
+    /// share the arrival rate and start at the same time.
+    uint64_t arrival_ns() const { return arrival_ns_; }
+
+    /// Loading records of the stream.
+    long loading_records() const { return loading_end_ - loading_begin_; }
+
+    /// Operations of the stream.
+    long operations() const { return operations_; }
+
+    /// Operations returned so far, counting every key of a scan.
+    long long n_requests() const { return n_requests_; }
+
+private:
+    /// Same as RequestGenerator::enter_operation_phase().
+    bool enter_operation_phase();
+
+    /// Same as RequestGenerator::next_arrival().
+    uint64_t next_arrival(long index);
+
+    long loading_begin_;
+    long loading_end_;
+    long operations_;
+    long n_records_;
+    bool gen_values_;
+
+    Phase phase_;
+    long loading_index_;
+    long operations_index_;
+    long long n_requests_;
+
+    /// Insert indices of the stream, starting at n_records.
+    acknowledged_counter<long> insert_keys_;
+    StreamInserts stream_inserts_;
+    const rfunc::feistel_permutation *insert_order_;
+    KeyEncoder key_encoder_;
+    char key_buffer_[KeyEncoder::MAX_SIZE];
+    GeneratorCounters *counters_;
+    std::unique_ptr<LiveKeySet> live_keys_;
+    /// Loading pipeline, which also generates the operations without phases.
+    std::unique_ptr<RequestPipeline> pipeline_;
+    std::vector<OperationPhase> phases_;
+    std::vector<std::unique_ptr<RequestPipeline>> phase_pipelines_;
+    RequestPipeline *operations_pipeline_;
+    size_t phase_index_;
+    bool phase_entered_;
+    std::chrono::steady_clock::time_point phase_deadline_;
+    std::unique_ptr<ArrivalProcess> arrivals_;
+    uint64_t arrival_sum_ = 0;
+    uint64_t arrival_ns_ = 0;
+};
+
+} // namespace workload
+
+#endif
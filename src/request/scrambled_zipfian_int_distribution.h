@@ -4,6 +4,7 @@
 #include <cmath>
 #include <mutex>
 #include <iostream>
+#include "feistel_permutation.h"
 #include "random.h"
 #include "zipfian_int_distribution.h"
 
@@ -14,23 +15,95 @@ public:
     template <typename _UniformRandomBitGenerator>
     _IntType operator()(_UniformRandomBitGenerator &__urng) {
         long ret = zipfian_int_distribution<long>::next(__urng);
-        long hash = fnvhash64(static_cast<uint64_t>(ret));
-        ret = min + hash % itemcount;
+        uint64_t hash;
+        ret = min + rotate(scramble(ret, hash));
         lastvalue = static_cast<_IntType>(ret);
         return static_cast<_IntType>(ret);
     }
 
+    /// Draw a value in [min, min + bound) without rejection. The popularity
+    /// rank is drawn as above, so every rank keeps its share of the draws.
+    /// Ranks scrambled at or past the bound are scrambled again over the
+    /// largest power of two not above it: their values only move when the
+    /// bound crosses a power of two. `bound` must be positive.
+    template <typename _UniformRandomBitGenerator>
+    _IntType operator()(_UniformRandomBitGenerator &__urng, _IntType bound) {
+        long ret = zipfian_int_distribution<long>::next(__urng);
+        uint64_t hash;
+        long offset = rotate(scramble(ret, hash));
+        if (offset >= bound) {
+            uint64_t fold = 1ULL
+                            << (63 - __builtin_clzll(
+                                         static_cast<uint64_t>(bound)));
+            offset = static_cast<long>(hash & (fold - 1));
+        }
+        lastvalue = static_cast<_IntType>(min + offset);
+        return lastvalue;
+    }
+
+    /// Move the hot values: ranks are scrambled with `salt` mixed into the
+    /// hash or the permutation seed (0: the original mapping), then shifted
+    /// by `rotation` values (down for a negative one), wrapping around.
+    void drift(uint64_t salt, long rotation) {
+        if (permuted && salt != drift_salt) {
+            permutation = rfunc::feistel_permutation(
+                static_cast<uint64_t>(itemcount), permutation_seed ^ salt);
+        }
+        drift_salt = salt;
+        // In [0, itemcount), so that rotate() only wraps upwards.
+        rotation %= static_cast<long>(itemcount);
+        if (rotation < 0) {
+            rotation += static_cast<long>(itemcount);
+        }
+        drift_rotation = static_cast<_IntType>(rotation);
+    }
+
+    /// Scramble ranks with a permutation of the values seeded by `seed`
+    /// instead of the FNV hash. Every value gets exactly one rank, where the
+    /// hash maps some ranks onto the same value and leaves others unused.
+    /// Ranks then cover exactly the values, with zeta approximated in
+    /// constant time.
+    void permute(uint64_t seed) {
+        zipfian_int_distribution<_IntType>::init(0, itemcount - 1,
+                                                 this->zipfianconstant,
+                                                 ZetaMode::APPROXIMATE);
+        permuted = true;
+        permutation_seed = seed;
+        permutation = rfunc::feistel_permutation(
+            static_cast<uint64_t>(itemcount), seed ^ drift_salt);
+    }
+
     scrambled_zipfian_int_distribution(
         _IntType min_, _IntType max_,
         double zipfianconstant_ =
-            zipfian_int_distribution<_IntType>::ZIPFIAN_CONSTANT) {
+            zipfian_int_distribution<_IntType>::ZIPFIAN_CONSTANT,
+        ZetaMode zeta_mode = ZetaMode::EXACT) {
         min = min_;
         max = max_;
         itemcount = max - min + 1;
         lastvalue = min;
-        if (zipfianconstant_ == USED_ZIPFIAN_CONSTANT) {
+        if (itemcount > ITEM_COUNT) {
+            // Past YCSB's rank space, ranks cover every value, and zeta is
+            // approximated in constant time instead of summed over them.
+            zipfian_int_distribution<_IntType>::init(
+                0, itemcount - 1, zipfianconstant_,
+                zipfian_int_distribution<_IntType>::zetaapprox(
+                    itemcount, zipfianconstant_,
+                    zipfian_int_distribution<_IntType>::zetastatic(
+                        zipfian_int_distribution<_IntType>::ZETA_HEAD,
+                        zipfianconstant_)));
+        } else if (zipfianconstant_ == USED_ZIPFIAN_CONSTANT) {
             zipfian_int_distribution<_IntType>::init(0, ITEM_COUNT,
                                                      zipfianconstant_, ZETAN);
+        } else if (zeta_mode == ZetaMode::APPROXIMATE) {
+            this->zetamode = zeta_mode;
+            this->zetahead = zipfian_int_distribution<_IntType>::zetastatic(
+                zipfian_int_distribution<_IntType>::ZETA_HEAD,
+                zipfianconstant_);
+            zipfian_int_distribution<_IntType>::init(
+                0, ITEM_COUNT, zipfianconstant_,
+                zipfian_int_distribution<_IntType>::zetaapprox(
+                    max - min + 1, zipfianconstant_, this->zetahead));
         } else {
             zipfian_int_distribution<_IntType>::init(
                 0, ITEM_COUNT, zipfianconstant_,
@@ -46,12 +119,22 @@ public:
         max = t.max;
         itemcount = t.itemcount;
         lastvalue = t.lastvalue;
+        drift_salt = t.drift_salt;
+        drift_rotation = t.drift_rotation;
+        permuted = t.permuted;
+        permutation_seed = t.permutation_seed;
+        permutation = t.permutation;
     }
 
 public:
     // zipfian_int_distribution<_IntType> *gen;
     _IntType min = 0, max = 0, itemcount = 0;
     _IntType lastvalue = 0;
+    uint64_t drift_salt = 0;
+    _IntType drift_rotation = 0;
+    bool permuted = false;
+    uint64_t permutation_seed = 0;
+    rfunc::feistel_permutation permutation;
 
     static uint64_t fnvhash64(uint64_t val) {
         uint64_t hashval = FNV_OFFSET_BASIS_64;
@@ -63,14 +146,47 @@ public:
             hashval = hashval ^ octet;
             hashval = hashval * FNV_PRIME_64;
         }
-        return labs(hashval);
+        // Magnitude of the hash as a signed value (YCSB's Math.abs), without
+        // the overflow of labs() at INT64_MIN.
+        return hashval >> 63 ? 0 - hashval : hashval;
     }
 
 private:
+    /// Offset in [0, itemcount) of `rank`; `hash` is set to the bits the
+    /// offset was reduced from.
+    long scramble(long rank, uint64_t &hash) const {
+        if (permuted) {
+            // The largest rank can reach itemcount when the uniform draw
+            // rounds to 1.
+            hash = permutation(static_cast<uint64_t>(
+                rank < itemcount ? rank : itemcount - 1));
+            return static_cast<long>(hash);
+        }
+        hash = fnvhash64(static_cast<uint64_t>(rank) ^ drift_salt);
+        return reduce(hash);
+    }
+
+    /// Offset of `hash` in [0, itemcount).
+    long reduce(uint64_t hash) const {
+        return static_cast<long>(hash % static_cast<uint64_t>(itemcount));
+    }
+
+    long rotate(long offset) const {
+        if (drift_rotation != 0) {
+            offset += drift_rotation;
+            if (offset >= itemcount) {
+                offset -= itemcount;
+            }
+        }
+        return offset;
+    }
+
     static const uint64_t FNV_OFFSET_BASIS_64 = 0xCBF29CE484222325L;
     static const uint64_t FNV_PRIME_64 = 1099511628211L;
     const double USED_ZIPFIAN_CONSTANT = 0.99;
     const double ZETAN = 26.46902820178302;
+    /// Ranks of YCSB's scrambled zipfian, with ZETAN as their zeta; larger
+    /// ranges rank all of their values.
     const long ITEM_COUNT = 10000000000L;
 };
 
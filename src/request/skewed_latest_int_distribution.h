@@ -26,20 +26,65 @@ public:
     _IntType next(_UniformRandomBitGenerator &__urng) {
         _IntType max = basis_->last_value();
         _IntType next = max - zipfian_int_distribution_->next(__urng, max);
+        next = shift(next, max + 1);
         last_value_ = next;
         return next;
     }
 
+    /// Draw a value in [0, bound) without rejection: the most recent value
+    /// below the bound is the most popular one. `bound` must be positive.
+    template <typename _UniformRandomBitGenerator>
+    _IntType next(_UniformRandomBitGenerator &__urng, _IntType bound) {
+        _IntType max = bound - 1;
+        _IntType offset = zipfian_int_distribution_->next(__urng, max);
+        _IntType next = offset < max ? max - offset : 0;
+        next = shift(next, bound);
+        last_value_ = next;
+        return next;
+    }
+
+    /// Move the most popular value `salt + rotation` values back from the
+    /// latest one, wrapping around to the largest values (0: the latest). A
+    /// negative `rotation` moves it forward, wrapping around to the
+    /// smallest values.
+    void drift(uint64_t salt, long rotation) {
+        shift_ = salt;
+        rotation_ = rotation;
+    }
+
     skewed_latest_int_distribution(const skewed_latest_int_distribution &t) {
         zipfian_int_distribution_ = t.zipfian_int_distribution_;
         basis_ = t.basis_;
         last_value_ = t.last_value_;
+        shift_ = t.shift_;
+        rotation_ = t.rotation_;
     }
 
 public:
     zipfian_int_distribution<_IntType> *zipfian_int_distribution_;
     acknowledged_counter<_IntType> *basis_;
     _IntType last_value_ = 0;
+    uint64_t shift_ = 0;
+    long rotation_ = 0;
+
+private:
+    /// `value` moved shift_ + rotation_ values down in [0, range).
+    _IntType shift(_IntType value, _IntType range) const {
+        if ((shift_ == 0 && rotation_ == 0) || range <= 0) {
+            return value;
+        }
+        // Both terms reduced to [0, range) first, so that the sum neither
+        // wraps nor depends on the sign of rotation_.
+        long rotation = rotation_ % range;
+        if (rotation < 0) {
+            rotation += range;
+        }
+        _IntType back = static_cast<_IntType>(
+            (shift_ % static_cast<uint64_t>(range) +
+             static_cast<uint64_t>(rotation)) %
+            static_cast<uint64_t>(range));
+        return value >= back ? value - back : value + range - back;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef WORKLOAD_STREAM_INSERTS_H
+#define WORKLOAD_STREAM_INSERTS_H
+
+namespace workload {
+
+/// Insert indices of one RequestStream. The pipeline of a stream draws
+/// insert indices as if the stream were the whole workload, so that its read
+/// bounds start at the last loading record and only ever cover its own
+/// inserts; index n_records + k, the k-th insert of the stream, stands for
+/// index start + k * stride of the whole workload. The default layout keeps
+/// every index.
+struct StreamInserts {
+    long n_records = 0;
+    long start = 0;
+    long stride = 1;
+
+    StreamInserts() {}
+    StreamInserts(long n_records_, long start_, long stride_) :
+        n_records(n_records_), start(start_), stride(stride_) {}
+
+    bool identity() const { return start == n_records && stride == 1; }
+
+    /// Index of the whole workload of stream index `index`.
+    long to_workload(long index) const {
+        return index < n_records ? index
+                                 : start + (index - n_records) * stride;
+    }
+
+    /// Stream index of `index`, an index of the whole workload that is a
+    /// loading record or an insert of the stream.
+    long to_stream(long index) const {
+        return index < n_records ? index
+                                 : n_records + (index - start) / stride;
+    }
+};
+
+} // namespace workload
+
+#endif
@@ -0,0 +1,265 @@
+#include "trace_writer.h"
+#include "binary_trace_format.h"
+#include "int_format.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+using namespace binary_trace;
+
+TraceWriter::TraceWriter(const RequestGenerator::Configuration &config) {
+    for (size_t i = 0; i < config.phases.size(); i++) {
+        phase_names_.push_back(config.phases[i].name);
+    }
+    marked_phase_ = phase_names_.size();
+}
+
+void TraceWriter::enter_phase(size_t index) {
+    if (index != marked_phase_ && index < phase_names_.size()) {
+        marked_phase_ = index;
+        write_phase_marker(index, phase_names_[index]);
+    }
+}
+
+void TraceWriter::write_batch(const RequestGenerator::RequestBatch &batch) {
+    for (size_t i = 0; i < batch.count; i++) {
+        if (batch.phases[i] == RequestGenerator::Phase::OPERATIONS) {
+            enter_phase(batch.phase_indices[i]);
+        }
+        write(batch.phases[i], batch.types[i], batch.keys[i],
+              batch.values.data() + batch.value_offsets[i],
+              batch.value_lengths[i], batch.scan_sizes[i],
+              batch.value_versions[i],
+              batch.types[i] == loadgen::types::Type::MULTI_GET
+                  ? batch.multi_get_keys.data() + batch.key_offsets[i]
+                  : nullptr,
+              batch.arrival_times[i]);
+    }
+}
+
+// ────────────────────────────────────────────────────────────────────────
+// CSV
+// ────────────────────────────────────────────────────────────────────────
+CsvTraceWriter::CsvTraceWriter(
+    OutputSink &sink, const RequestGenerator::Configuration &config) :
+    TraceWriter(config), sink_(sink), key_encoder_(config),
+    derived_values_(config.value_generator == "DERIVED"),
+    timed_(config.arrival != "NONE") {
+    if (!key_encoder_.text()) {
+        throw invalid_argument("CSV traces need text keys; BINARY keys "
+                               "need export_format = \"BINARY\"");
+    }
+}
+
+// Longest line without its value: '@', a 64-bit time, type, four commas, '#',
+// the key and two 64-bit numbers, newline.
+static const size_t MAX_CSV_LINE = 100 + KeyEncoder::MAX_SIZE;
+// Comma and key of each extra MULTI_GET key.
+static const size_t MAX_CSV_KEY = 1 + KeyEncoder::MAX_SIZE;
+
+void CsvTraceWriter::write(RequestGenerator::Phase phase,
+                           loadgen::types::Type type, long key,
+                           const char *value, size_t value_length,
+                           long scan_size, uint64_t value_version,
+                           const long *keys, uint64_t arrival_ns) {
+    size_t extra_keys = type == loadgen::types::Type::MULTI_GET
+                            ? static_cast<size_t>(scan_size) - 1
+                            : 0;
+    char *start =
+        sink_.reserve(MAX_CSV_LINE + value_length + extra_keys * MAX_CSV_KEY);
+    char *out = start;
+    if (timed_ && phase == RequestGenerator::Phase::OPERATIONS) {
+        // '@' never starts a request line either.
+        *out++ = '@';
+        out = write_decimal(out, static_cast<long>(arrival_ns));
+        *out++ = ',';
+    }
+    out = write_decimal(out, static_cast<int>(type));
+    *out++ = ',';
+    out += key_encoder_.encode(key, out);
+    if ((type == loadgen::types::Type::WRITE ||
+         type == loadgen::types::Type::READ_MODIFY_WRITE) &&
+        value_length > 0) {
+        *out++ = ',';
+        if (derived_values_) {
+            // '#' is not in the value charset.
+            *out++ = '#';
+            out = write_decimal(out, static_cast<long>(value_length));
+            *out++ = ',';
+            out = write_decimal(out, static_cast<long>(value_version));
+        } else {
+            memcpy(out, value, value_length);
+            out += value_length;
+        }
+    } else if (type == loadgen::types::Type::SCAN) {
+        *out++ = ',';
+        out = write_decimal(out, scan_size);
+    } else if (type == loadgen::types::Type::MULTI_GET) {
+        for (size_t i = 1; i <= extra_keys; i++) {
+            *out++ = ',';
+            out += key_encoder_.encode(keys[i], out);
+        }
+    }
+    *out++ = '\n';
+    sink_.advance(static_cast<size_t>(out - start));
+}
+
+void CsvTraceWriter::write_phase_marker(size_t index,
+                                        const std::string &name) {
+    // '#' never starts a request line.
+    static const char PREFIX[] = "#phase,";
+    char *start = sink_.reserve(MAX_CSV_LINE + name.size());
+    char *out = start;
+    memcpy(out, PREFIX, sizeof(PREFIX) - 1);
+    out += sizeof(PREFIX) - 1;
+    out = write_decimal(out, static_cast<long>(index));
+    *out++ = ',';
+    memcpy(out, name.data(), name.size());
+    out += name.size();
+    *out++ = '\n';
+    sink_.advance(static_cast<size_t>(out - start));
+}
+
+void CsvTraceWriter::finish() {}
+
+// ────────────────────────────────────────────────────────────────────────
+// Binary
+// ────────────────────────────────────────────────────────────────────────
+BinaryTraceWriter::BinaryTraceWriter(
+    OutputSink &sink, const RequestGenerator::Configuration &config,
+    size_t block_size) :
+    TraceWriter(config), sink_(sink), gen_values_(config.gen_values),
+    derived_values_(config.value_generator == "DERIVED"),
+    timed_(config.arrival != "NONE"),
+    block_size_(block_size > 0 ? block_size : 1) {
+    // Records carry values when any phase generates them.
+    RequestGenerator::Configuration stored = config;
+    for (size_t i = 0; i < config.phases.size(); i++) {
+        stored.gen_values = stored.gen_values || config.phases[i].gen_values;
+    }
+    gen_values_ = stored.gen_values;
+
+    string header;
+    header.append(MAGIC, sizeof(MAGIC));
+    put_fixed(header, timed_ ? VERSION : UNTIMED_VERSION, 4);
+    string body;
+    put_configuration(body, stored);
+    put_varint(header, body.size());
+    header += body;
+
+    sink_.write(header.data(), header.size());
+    offset_ = header.size();
+}
+
+void BinaryTraceWriter::write(RequestGenerator::Phase phase,
+                              loadgen::types::Type type, long key,
+                              const char *value, size_t value_length,
+                              long scan_size, uint64_t value_version,
+                              const long *keys, uint64_t arrival_ns) {
+    uint8_t tag = static_cast<uint8_t>(type);
+    if (phase == RequestGenerator::Phase::LOADING) {
+        tag |= LOADING_FLAG;
+    }
+    block_.push_back(static_cast<char>(tag));
+    put_varint(block_, zigzag(static_cast<int64_t>(key) - previous_key_));
+    previous_key_ = key;
+    if (timed_ && phase == RequestGenerator::Phase::OPERATIONS) {
+        put_varint(block_, zigzag(static_cast<int64_t>(arrival_ns -
+                                                       previous_arrival_)));
+        previous_arrival_ = arrival_ns;
+    }
+
+    if (type == loadgen::types::Type::SCAN) {
+        put_varint(block_, static_cast<uint64_t>(scan_size));
+    } else if (type == loadgen::types::Type::MULTI_GET) {
+        // Key count, then each further key as a delta from the one before.
+        put_varint(block_, static_cast<uint64_t>(scan_size));
+        for (long i = 1; i < scan_size; i++) {
+            put_varint(block_, zigzag(static_cast<int64_t>(keys[i]) -
+                                      keys[i - 1]));
+        }
+    } else if ((type == loadgen::types::Type::WRITE ||
+                type == loadgen::types::Type::READ_MODIFY_WRITE) &&
+               gen_values_) {
+        put_varint(block_, value_length);
+        if (derived_values_) {
+            put_varint(block_, value_version);
+        } else {
+            block_.append(value, value_length);
+        }
+    }
+
+    if (++block_records_ == block_size_) {
+        flush_block();
+    }
+}
+
+void BinaryTraceWriter::write_phase_marker(size_t index,
+                                           const std::string &name) {
+    put_fixed(phase_table_, records_ + block_records_, 8);
+    put_fixed(phase_table_, index, 4);
+    put_varint(phase_table_, name.size());
+    phase_table_ += name;
+    phase_entries_++;
+}
+
+void BinaryTraceWriter::flush_block() {
+    if (block_records_ == 0) {
+        return;
+    }
+    uint64_t first = records_;
+
+    string header;
+    put_fixed(header, block_records_, 4);
+    put_fixed(header, block_.size(), 4);
+    put_fixed(header, first, 8);
+    sink_.write(header.data(), header.size());
+    sink_.write(block_.data(), block_.size());
+
+    put_fixed(index_, offset_, 8);
+    put_fixed(index_, first, 8);
+    put_fixed(index_, block_records_, 4);
+    blocks_++;
+
+    offset_ += header.size() + block_.size();
+    records_ += block_records_;
+    block_.clear();
+    block_records_ = 0;
+    previous_key_ = 0;
+    previous_arrival_ = 0;
+}
+
+void BinaryTraceWriter::finish() {
+    flush_block();
+
+    string footer;
+    put_fixed(footer, offset_, 8);
+    put_fixed(footer, blocks_, 8);
+    put_fixed(footer, records_, 8);
+    footer.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+
+    sink_.write(index_.data(), index_.size());
+    if (phase_entries_ > 0) {
+        string count;
+        put_fixed(count, phase_entries_, 4);
+        sink_.write(count.data(), count.size());
+        sink_.write(phase_table_.data(), phase_table_.size());
+    }
+    sink_.write(footer.data(), footer.size());
+}
+
+unique_ptr<TraceWriter>
+make_trace_writer(const RequestGenerator::Configuration &config,
+                  OutputSink &sink) {
+    if (config.export_format == "CSV") {
+        return unique_ptr<TraceWriter>(new CsvTraceWriter(sink, config));
+    } else if (config.export_format == "BINARY") {
+        return unique_ptr<TraceWriter>(
+            new BinaryTraceWriter(sink, config, config.block_size));
+    }
+    throw invalid_argument("Unknown output format: " + config.export_format);
+}
+
+} // namespace workload
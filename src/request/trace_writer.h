@@ -0,0 +1,126 @@
+#ifndef WORKLOAD_TRACE_WRITER_H
+#define WORKLOAD_TRACE_WRITER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "key_encoder.h"
+#include "output_sink.h"
+#include "request_generator.h"
+#include "../types/types.h"
+
+namespace workload {
+
+/// Encoder of exported traces, selected by `output.requests.format`.
+class TraceWriter {
+public:
+    virtual ~TraceWriter() {}
+
+    /// Append one request to the trace. `value_version` is only stored for
+    /// DERIVED values, in place of the value bytes. `keys` holds the
+    /// `scan_size` keys of a MULTI_GET (`key` first) and is ignored for the
+    /// other types. `arrival_ns` is only stored for the operations of
+    /// workloads with arrivals.
+    virtual void write(RequestGenerator::Phase phase,
+                       loadgen::types::Type type, long key, const char *value,
+                       size_t value_length, long scan_size,
+                       uint64_t value_version, const long *keys,
+                       uint64_t arrival_ns) = 0;
+
+    /// Append entries [0, batch.count) of `batch`, with their phase
+    /// markers.
+    void write_batch(const RequestGenerator::RequestBatch &batch);
+
+    /// Mark the start of operation phase `index` before the next request,
+    /// unless it is already the current one. Only workloads with
+    /// Configuration::phases are marked.
+    void enter_phase(size_t index);
+
+    /// Write whatever is still buffered. Must be called once at the end.
+    virtual void finish() = 0;
+
+protected:
+    explicit TraceWriter(const RequestGenerator::Configuration &config);
+
+private:
+    virtual void write_phase_marker(size_t index, const std::string &name) = 0;
+
+    std::vector<std::string> phase_names_;
+    /// Phase of the last marker, phase_names_.size() before the first one.
+    size_t marked_phase_;
+};
+
+/// `type,key[,value|,limit|,key...]` lines, keys in their key_encoding (10
+/// zero-padded digits by default). DERIVED values are written as
+/// `#length,version` and phase markers as `#phase,index,name` lines. With
+/// arrivals, operation lines start with `@arrival_ns,`. Lines are formatted
+/// directly into the sink buffer.
+class CsvTraceWriter : public TraceWriter {
+public:
+    /// @throws std::invalid_argument for BINARY keys, which may hold commas
+    /// and newlines.
+    CsvTraceWriter(OutputSink &sink,
+                   const RequestGenerator::Configuration &config);
+
+    void write(RequestGenerator::Phase phase, loadgen::types::Type type,
+               long key, const char *value, size_t value_length,
+               long scan_size, uint64_t value_version, const long *keys,
+               uint64_t arrival_ns) override;
+    void finish() override;
+
+private:
+    void write_phase_marker(size_t index, const std::string &name) override;
+
+    OutputSink &sink_;
+    KeyEncoder key_encoder_;
+    bool derived_values_;
+    bool timed_;
+};
+
+/// Block-based binary trace, see binary_trace_format.h.
+class BinaryTraceWriter : public TraceWriter {
+public:
+    /// @param[in] config      Configuration stored in the trace header.
+    /// @param[in] block_size  Records per block.
+    BinaryTraceWriter(OutputSink &sink,
+                      const RequestGenerator::Configuration &config,
+                      size_t block_size);
+
+    void write(RequestGenerator::Phase phase, loadgen::types::Type type,
+               long key, const char *value, size_t value_length,
+               long scan_size, uint64_t value_version, const long *keys,
+               uint64_t arrival_ns) override;
+    void finish() override;
+
+private:
+    void write_phase_marker(size_t index, const std::string &name) override;
+    void flush_block();
+
+    OutputSink &sink_;
+    bool gen_values_;
+    bool derived_values_;
+    bool timed_;
+    size_t block_size_;
+    std::string block_;
+    uint32_t block_records_ = 0;
+    long previous_key_ = 0;
+    uint64_t previous_arrival_ = 0;
+    uint64_t records_ = 0;
+    uint64_t offset_ = 0;
+    std::string index_;
+    uint64_t blocks_ = 0;
+    /// Phase table entries, written after the block index.
+    std::string phase_table_;
+    uint32_t phase_entries_ = 0;
+};
+
+/// Writer for `config.export_format` ("CSV" or "BINARY").
+std::unique_ptr<TraceWriter>
+make_trace_writer(const RequestGenerator::Configuration &config,
+                  OutputSink &sink);
+
+} // namespace workload
+
+#endif
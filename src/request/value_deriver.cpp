@@ -0,0 +1,70 @@
+#include "value_deriver.h"
+#include "char_generator.h"
+#include "counter_engine.h"
+
+#include <algorithm>
+
+namespace workload {
+using namespace std;
+
+// ────────────────────────────────────────────────────────────────────────
+// Byte stream of a value
+// ────────────────────────────────────────────────────────────────────────
+// The key selects a stream seed and the version a stream of it; each draw
+// gives eight characters.
+
+static rfunc::counter_engine value_engine(uint64_t seed, long key,
+                                          uint64_t version) {
+    rfunc::counter_engine key_engine(seed, static_cast<uint64_t>(key));
+    return rfunc::counter_engine(key_engine(), version);
+}
+
+template <typename Visit>
+static void for_each_block(uint64_t seed, long key, uint64_t version,
+                           size_t length, Visit visit) {
+    rfunc::counter_engine engine = value_engine(seed, key, version);
+    for (size_t i = 0; i < length; i += 8) {
+        uint64_t bits = engine();
+        char block[8];
+        size_t n = min<size_t>(8, length - i);
+        for (size_t j = 0; j < n; j++) {
+            block[j] =
+                CharGenerator::from_byte(static_cast<unsigned char>(bits));
+            bits >>= 8;
+        }
+        if (!visit(i, block, n)) {
+            return;
+        }
+    }
+}
+
+void ValueDeriver::fill(long key, uint64_t version, char *out,
+                        size_t length) const {
+    for_each_block(seed_, key, version, length,
+                   [out](size_t offset, const char *block, size_t n) {
+                       copy(block, block + n, out + offset);
+                       return true;
+                   });
+}
+
+void ValueDeriver::assign(long key, uint64_t version, size_t length,
+                          std::string &value) const {
+    value.resize(length);
+    if (length > 0) {
+        fill(key, version, &value[0], length);
+    }
+}
+
+bool ValueDeriver::verify(long key, uint64_t version, const char *data,
+                          size_t length) const {
+    bool equal_bytes = true;
+    for_each_block(seed_, key, version, length,
+                   [data, &equal_bytes](size_t offset, const char *block,
+                                        size_t n) {
+                       equal_bytes = equal(block, block + n, data + offset);
+                       return equal_bytes;
+                   });
+    return equal_bytes;
+}
+
+} // namespace workload
@@ -0,0 +1,38 @@
+#ifndef WORKLOAD_VALUE_DERIVER_H
+#define WORKLOAD_VALUE_DERIVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace workload {
+
+/// Values of `value_generator = "DERIVED"`.
+///
+/// The bytes of a value are a pure function of (value_seed, key, version),
+/// so traces only store the length and version of each value and replayers
+/// regenerate or check the bytes on demand. The version of a write is its
+/// position in the workload: loading record i has version i and operation j
+/// has version n_records + j.
+class ValueDeriver {
+public:
+    explicit ValueDeriver(uint64_t seed) : seed_(seed) {}
+
+    /// Write the first `length` bytes of the value of (key, version).
+    void fill(long key, uint64_t version, char *out, size_t length) const;
+
+    /// Replace `value` with the value of (key, version).
+    void assign(long key, uint64_t version, size_t length,
+                std::string &value) const;
+
+    /// True when `data` holds the value of (key, version).
+    bool verify(long key, uint64_t version, const char *data,
+                size_t length) const;
+
+private:
+    uint64_t seed_;
+};
+
+} // namespace workload
+
+#endif
@@ -0,0 +1,51 @@
+#include "value_pool.h"
+#include "char_generator.h"
+#include "engines.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace workload {
+using namespace std;
+
+ValuePool::ValuePool(size_t size, size_t max_value_size,
+                     double compression_ratio, uint64_t seed) :
+    size_(size > 0 ? size : 1) {
+    if (!(compression_ratio > 0 && compression_ratio <= 1)) {
+        throw invalid_argument(
+            "value_compression_ratio must be in (0, 1]");
+    }
+
+    // Slices may start at any offset below size_, so the last one needs
+    // max_value_size bytes after it.
+    data_.resize(size_ + max_value_size);
+    char *out = &data_[0];
+    size_t total = data_.size();
+
+    // Eight characters per engine draw.
+    rfunc::xoshiro256ss engine(seed);
+    for (size_t i = 0; i < total; i += 8) {
+        uint64_t bits = engine();
+        size_t n = min<size_t>(8, total - i);
+        for (size_t j = 0; j < n; j++) {
+            out[i + j] =
+                CharGenerator::from_byte(static_cast<unsigned char>(bits));
+            bits >>= 8;
+        }
+    }
+
+    if (compression_ratio < 1) {
+        size_t random = max<size_t>(
+            1, static_cast<size_t>(ceil(PIECE_SIZE * compression_ratio)));
+        for (size_t piece = 0; piece < total; piece += PIECE_SIZE) {
+            size_t end = min(piece + PIECE_SIZE, total);
+            for (size_t i = piece + random; i < end; i++) {
+                out[i] = out[i - random];
+            }
+        }
+    }
+}
+
+} // namespace workload
@@ -0,0 +1,46 @@
+#ifndef WORKLOAD_VALUE_POOL_H
+#define WORKLOAD_VALUE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "byte_view.h"
+
+namespace workload {
+
+/// Block of pre-generated value bytes that values are sliced from.
+///
+/// The bytes come from the CharGenerator charset, so values stay valid CSV
+/// fields. With a compression ratio r < 1, each PIECE_SIZE piece holds
+/// r * PIECE_SIZE random bytes followed by repetitions of them, so that
+/// values compress to about r of their size (as db_bench does).
+class ValuePool {
+public:
+    /// Length of the compressible pieces.
+    static const size_t PIECE_SIZE = 100;
+
+    /// @param[in] size              Number of distinct value start offsets.
+    /// @param[in] max_value_size    Longest value sliced from the pool.
+    /// @param[in] compression_ratio Fraction of random bytes, in (0, 1].
+    /// @param[in] seed              Seed of the fill.
+    ValuePool(size_t size, size_t max_value_size, double compression_ratio,
+              uint64_t seed);
+
+    /// Number of distinct value start offsets.
+    size_t size() const { return size_; }
+
+    /// The `length` bytes starting at `offset` (offset < size(), length up
+    /// to max_value_size). Valid for the lifetime of the pool.
+    ByteView slice(size_t offset, size_t length) const {
+        return ByteView(data_.data() + offset, length);
+    }
+
+private:
+    size_t size_;
+    std::string data_;
+};
+
+} // namespace workload
+
+#endif
@@ -2,7 +2,18 @@
 #define RFUNC_ZIPFIAN_H
 
 #include <cmath>
+#include <istream>
 #include <mutex>
+#include <ostream>
+
+/// How zipfian_int_distribution computes zeta(n, theta).
+enum class ZetaMode {
+    /// Sum every term, as YCSB does: O(n) setup and O(delta) growth.
+    EXACT,
+    /// Sum the first ZETA_HEAD terms and add the Euler–Maclaurin expansion of
+    /// the rest: constant-time setup and growth, relative error below 1e-12.
+    APPROXIMATE,
+};
 
 template <typename _IntType = int> class zipfian_int_distribution {
 
@@ -21,6 +32,11 @@ public:
 
     zipfian_int_distribution(_IntType min, _IntType max) { init(min, max); }
 
+    zipfian_int_distribution(_IntType min, _IntType max, ZetaMode mode,
+                             double zipfian_constant = ZIPFIAN_CONSTANT) {
+        init(min, max, zipfian_constant, mode);
+    }
+
     zipfian_int_distribution(const zipfian_int_distribution &t) {
         items = t.items;
         base = t.base;
@@ -33,8 +49,13 @@ public:
         countforzeta = t.countforzeta;
         allowitemcountdecrease = t.allowitemcountdecrease;
         lastvalue = t.lastvalue;
+        zetamode = t.zetamode;
+        zetahead = t.zetahead;
     }
 
+    zipfian_int_distribution &
+    operator=(const zipfian_int_distribution &t) = default;
+
     template <typename _UniformRandomBitGenerator>
     _IntType next(_UniformRandomBitGenerator &__urng) {
         return next(__urng, items);
@@ -46,17 +67,7 @@ public:
         constexpr auto __urngmin = _UniformRandomBitGenerator::min();
         constexpr auto __urngmax = _UniformRandomBitGenerator::max();
 
-        if (itemcount != countforzeta) {
-            if (itemcount > countforzeta) {
-                zetan = zeta(countforzeta, itemcount, theta, zetan);
-                eta = (1 - pow(2.0 / items, 1 - theta)) /
-                      (1 - zeta2theta / zetan);
-            } else if ((itemcount < countforzeta) && (allowitemcountdecrease)) {
-                zetan = zeta(itemcount, theta);
-                eta = (1 - pow(2.0 / items, 1 - theta)) /
-                      (1 - zeta2theta / zetan);
-            }
-        }
+        update_itemcount(itemcount);
 
         double random = (double)__urng();
         double u = (double)((random - __urngmin) / (__urngmax - __urngmin));
@@ -76,6 +87,40 @@ public:
         return ret;
     }
 
+    /// Bring zetan/eta up to date for `itemcount` items. Growing the count
+    /// continues the zeta sum where it stopped, so the result does not depend
+    /// on the intermediate counts it went through.
+    void update_itemcount(_IntType itemcount) {
+        if (itemcount != countforzeta) {
+            if (itemcount > countforzeta) {
+                zetan = zeta(countforzeta, itemcount, theta, zetan);
+                eta = (1 - pow(2.0 / items, 1 - theta)) /
+                      (1 - zeta2theta / zetan);
+            } else if ((itemcount < countforzeta) && (allowitemcountdecrease)) {
+                zetan = zeta(itemcount, theta);
+                eta = (1 - pow(2.0 / items, 1 - theta)) /
+                      (1 - zeta2theta / zetan);
+            }
+        }
+    }
+
+    /// Text state of the zeta sum that update_itemcount() extends, with
+    /// every double written exactly; the other fields only depend on the
+    /// constructor arguments.
+    friend std::ostream &operator<<(std::ostream &os,
+                                    const zipfian_int_distribution &d) {
+        std::streamsize precision = os.precision(17);
+        os << d.countforzeta << ' ' << d.zetan << ' ' << d.eta << ' '
+           << d.lastvalue;
+        os.precision(precision);
+        return os;
+    }
+
+    friend std::istream &operator>>(std::istream &is,
+                                    zipfian_int_distribution &d) {
+        return is >> d.countforzeta >> d.zetan >> d.eta >> d.lastvalue;
+    }
+
 protected:
     void init(_IntType min, _IntType max, double zipfian_constant,
               double zetan_) {
@@ -96,8 +141,24 @@ protected:
              zetastatic(max - min + 1, ZIPFIAN_CONSTANT));
     }
 
+    void init(_IntType min, _IntType max, double zipfian_constant,
+              ZetaMode mode) {
+        zetamode = mode;
+        if (mode == ZetaMode::APPROXIMATE) {
+            zetahead = zetastatic(ZETA_HEAD, zipfian_constant);
+            init(min, max, zipfian_constant,
+                 zetaapprox(max - min + 1, zipfian_constant, zetahead));
+        } else {
+            init(min, max, zipfian_constant,
+                 zetastatic(max - min + 1, zipfian_constant));
+        }
+    }
+
     double zeta(long n, double thetaVal) {
         countforzeta = n;
+        if (zetamode == ZetaMode::APPROXIMATE) {
+            return zetaapprox(n, thetaVal, zetahead);
+        }
         return zetastatic(n, thetaVal);
     }
 
@@ -107,6 +168,9 @@ protected:
 
     double zeta(long st, long n, double thetaVal, double initialsum) {
         countforzeta = n;
+        if (zetamode == ZetaMode::APPROXIMATE && n > ZETA_HEAD) {
+            return zetaapprox(n, thetaVal, zetahead);
+        }
         return zetastatic(st, n, thetaVal, initialsum);
     }
 
@@ -119,19 +183,57 @@ protected:
         return sum;
     }
 
+public:
+    /// zeta(n, theta) from `head` = zeta(ZETA_HEAD, theta) and the
+    /// Euler–Maclaurin expansion of the remaining terms. Exact up to
+    /// ZETA_HEAD items.
+    static double zetaapprox(long n, double theta, double head) {
+        if (n <= ZETA_HEAD) {
+            return zetastatic(n, theta);
+        }
+        // With f(x) = x^-theta and K = ZETA_HEAD:
+        //   sum_{i=K..n} f(i) = int_K^n f + (f(K) + f(n)) / 2
+        //                       + (f1(n) - f1(K)) / 12 - (f3(n) - f3(K)) / 720
+        // where f1, f3 are the first and third derivatives; the next term is
+        // below 1e-20.
+        const double k = static_cast<double>(ZETA_HEAD);
+        const double x = static_cast<double>(n);
+        double integral;
+        if (theta == 1.0) {
+            integral = log(x / k);
+        } else {
+            // k^(1-theta) * ((x/k)^(1-theta) - 1) / (1-theta), stable near 1.
+            integral = pow(k, 1 - theta) * expm1((1 - theta) * log(x / k)) /
+                       (1 - theta);
+        }
+        double fk = pow(k, -theta), fx = pow(x, -theta);
+        double f1k = -theta * fk / k, f1x = -theta * fx / x;
+        double c3 = -theta * (theta + 1) * (theta + 2);
+        double f3k = c3 * fk / (k * k * k), f3x = c3 * fx / (x * x * x);
+        double tail = integral + (fk + fx) / 2 + (f1x - f1k) / 12 -
+                      (f3x - f3k) / 720;
+        // The head already counts f(K).
+        return head + tail - fk;
+    }
+
     // rfunc::DoubleRandFunction uniform =
     // rfunc::uniform_double_distribution_rand(0.0, 1.0);
 public:
     static constexpr double ZIPFIAN_CONSTANT = 0.99;
+    /// Terms summed exactly by ZetaMode::APPROXIMATE.
+    static constexpr long ZETA_HEAD = 1024;
 
 protected:
-    _IntType items;
-    _IntType base;
-    double zipfianconstant;
-    double alpha, zetan, eta, theta, zeta2theta;
-    _IntType countforzeta;
+    _IntType items = 0;
+    _IntType base = 0;
+    double zipfianconstant = 0;
+    double alpha = 0, zetan = 0, eta = 0, theta = 0, zeta2theta = 0;
+    _IntType countforzeta = 0;
     bool allowitemcountdecrease = false;
     _IntType lastvalue = 0;
+    ZetaMode zetamode = ZetaMode::EXACT;
+    /// zeta(ZETA_HEAD, theta), used by ZetaMode::APPROXIMATE.
+    double zetahead = 0;
 };
 
 #endif
\ No newline at end of file
@@ -10,6 +10,8 @@ enum class Type {
     SCAN,
     DEL,
     UPDATE,
+    READ_MODIFY_WRITE,
+    MULTI_GET,
 };
 
 } // namespace types